@@ -19,6 +19,8 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -37,6 +39,23 @@
 #include "helpers/rtos_helper_mutex.hpp"
 #include "helpers/rtos_helper_counter.hpp"
 #include "helpers/rtos_helper_timer.hpp"
+#include "helpers/rtos_helper_timestamp.hpp"
+#include "helpers/rtos_helper_atomic.hpp"
+#include "helpers/rtos_helper_profiler.hpp"
+#include "helpers/rtos_helper_ring.hpp"
+#include "helpers/rtos_helper_idle.hpp"
+#include "helpers/rtos_helper_budget.hpp"
+#include "helpers/rtos_helper_cyclic.hpp"
+#include "helpers/rtos_helper_sched_analysis.hpp"
+#include "helpers/rtos_helper_rpc.hpp"
+#include "helpers/rtos_helper_event_kernel.hpp"
+#include "helpers/rtos_helper_task_slab.hpp"
+#include "helpers/rtos_helper_condvar.hpp"
+#include "helpers/rtos_helper_bip.hpp"
+#include "helpers/rtos_helper_lf_stack.hpp"
+#include "helpers/rtos_helper_buf_chain.hpp"
+#include "helpers/rtos_helper_shared_buf.hpp"
+#include "helpers/rtos_helper_map.hpp"
 
 // clang-format off
 
@@ -0,0 +1,226 @@
+#include "FreeRTOS_helper.hpp"
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+#include <atomic>
+#endif
+
+// Cost of OSAtomic operations on current platform:
+//  - "load", "store", "fetch_add", "cas" - single Task, no contention;
+//  - "fetch_add_contended" - two Tasks (on different cores if possible)
+//    incrementing the same counter;
+//  - "critical" and "mutex" - the same increment guarded by
+//    OSCriticalSection and OSMutex, as a reference.
+// On Xtensa, RISC-V with "A" extension and Cortex-M3+ native instructions are used,
+// on RP2040 (Cortex-M0+) every operation goes through critical section.
+// Host builds (see "Host builds and interleaving tests" in README.md) run the same tests
+// with std::atomic as a reference.
+//
+// Every test is printed as CSV line:
+//   atomic,<test>,<impl>,<iterations>,<ticks_per_op>,<ns_per_op>
+// where "impl" is "native", "critical" or "std_atomic"
+// and "ticks" are units of OSTimestamp.
+
+// Amount of operations per test
+#define BENCH_ITERATIONS 100000u
+
+// Declaration of Task code
+void vBenchTask(void* pvArg);
+void vContenderTask(void* pvArg);
+
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <4096> BenchTask(vBenchTask, "Bench", nullptr, tskIDLE_PRIORITY + 2, OS_MCU_CORE_0);
+OSTask <2048> ContenderTask(vContenderTask, "Contender", nullptr, tskIDLE_PRIORITY + 1, OS_MCU_CORE_1);
+#else
+OSTask <4096> BenchTask(vBenchTask, "Bench", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <2048> ContenderTask(vContenderTask, "Contender", nullptr, tskIDLE_PRIORITY + 2);
+#endif
+
+OSAtomic<uint32_t> sharedCounter;
+OSCriticalSection counterLock;
+OSMutex counterMutex;
+Counter <1> ContenderDone;
+
+volatile uint32_t plainCounter = 0u;
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+std::atomic<uint32_t> stdCounter{0u};
+// Tells Contender which counter to increment
+volatile bool contendStd = false;
+#endif
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  counterMutex.init();
+  ContenderDone.init();
+
+  ContenderTask.setArg(reinterpret_cast<void*>(&ContenderTask));
+  ContenderTask.init();
+  BenchTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void printResult(const char* test, const char* impl, uint32_t elapsedTicks)
+{
+  Serial.printf("atomic,%s,%s,%u,%u,%u\n", test, impl,
+                (unsigned)BENCH_ITERATIONS, (unsigned)(elapsedTicks / BENCH_ITERATIONS),
+                (unsigned)(OSTimestamp::toNs(elapsedTicks) / BENCH_ITERATIONS));
+}
+
+void vContenderTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+
+  for (;;) {
+    self->waitSignal();
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+    if (contendStd) {
+      for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+        stdCounter.fetch_add(1u);
+      }
+      ContenderDone.give();
+      continue;
+    }
+#endif
+
+    for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+      sharedCounter.fetchAdd(1u);
+    }
+
+    ContenderDone.give();
+  }
+}
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+// Same tests with std::atomic, reference for OSAtomic in host builds
+void benchStdAtomic()
+{
+  uint32_t start = 0u;
+  uint32_t sink = 0u;
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    sink += stdCounter.load();
+  }
+  printResult("load", "std_atomic", OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    stdCounter.store(i);
+  }
+  printResult("store", "std_atomic", OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    stdCounter.fetch_add(1u);
+  }
+  printResult("fetch_add", "std_atomic", OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    uint32_t expected = stdCounter.load();
+    while (!stdCounter.compare_exchange_weak(expected, expected + 1u)) {
+    }
+  }
+  printResult("cas", "std_atomic", OSTimestamp::now() - start);
+
+  stdCounter.store(0u);
+  contendStd = true;
+  ContenderTask.emitSignal();
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    stdCounter.fetch_add(1u);
+  }
+  ContenderDone.take();
+  printResult("fetch_add_contended", "std_atomic", OSTimestamp::now() - start);
+
+  if (stdCounter.load() != (2u * BENCH_ITERATIONS)) {
+    Serial.printf("atomic,error,lost_updates,%u\n", (unsigned)(2u * BENCH_ITERATIONS - stdCounter.load()));
+  }
+
+  (void)sink;
+}
+#endif
+
+void vBenchTask([[maybe_unused]] void* pvArg)
+{
+  const char* impl = OSAtomic<uint32_t>::isNative() ? "native" : "critical";
+  uint32_t start = 0u;
+  uint32_t sink = 0u;
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    sink += sharedCounter.load();
+  }
+  printResult("load", impl, OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    sharedCounter.store(i);
+  }
+  printResult("store", impl, OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    sharedCounter.fetchAdd(1u);
+  }
+  printResult("fetch_add", impl, OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    uint32_t expected = sharedCounter.load();
+    while (!sharedCounter.compareExchange(expected, expected + 1u)) {
+    }
+  }
+  printResult("cas", impl, OSTimestamp::now() - start);
+
+  sharedCounter.store(0u);
+  ContenderTask.emitSignal();
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    sharedCounter.fetchAdd(1u);
+  }
+  ContenderDone.take();
+  printResult("fetch_add_contended", impl, OSTimestamp::now() - start);
+
+  if (sharedCounter.load() != (2u * BENCH_ITERATIONS)) {
+    Serial.printf("atomic,error,lost_updates,%u\n", (unsigned)(2u * BENCH_ITERATIONS - sharedCounter.load()));
+  }
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    auto xStatus = counterLock.enter();
+    plainCounter++;
+    counterLock.exit(xStatus);
+  }
+  printResult("fetch_add", "critical_section", OSTimestamp::now() - start);
+
+  start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+    counterMutex.lock();
+    plainCounter++;
+    counterMutex.unlock();
+  }
+  printResult("fetch_add", "mutex", OSTimestamp::now() - start);
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+  benchStdAtomic();
+#endif
+
+  (void)sink;
+
+  for (;;) {
+    OSTask<0>::delay(1000);
+  }
+}
@@ -0,0 +1,230 @@
+#include "FreeRTOS_helper.hpp"
+
+// Microbenchmarks of scheduler overhead with ping-pong Task pairs:
+//  - "yield"    - OSTask::yield() between two equal priority Tasks;
+//  - "delay0"   - OSTask::delay(0) between two equal priority Tasks;
+//  - "signal"   - waitSignal()/emitSignal() ping-pong;
+//  - "mutex"    - OSMutex handoff to higher priority waiter.
+// Signal and mutex tests run with both Tasks on the same core,
+// and on multi-core MCU with Tasks on different cores.
+//
+// Every test is printed as CSV line:
+//   switch,<test>,<placement>,<iterations>,<ticks_per_op>,<ns_per_op>
+// where "ticks" are units of OSTimestamp (CPU cycles on target,
+// nanoseconds in host builds) and "op" is one switch or one handoff.
+
+// Amount of ping-pong iterations per test
+#define BENCH_ITERATIONS 10000u
+
+enum {
+  BENCH_YIELD = 0,
+  BENCH_DELAY0,
+  BENCH_SIGNAL,
+  BENCH_MUTEX,
+};
+
+const char* testNames[] = {"yield", "delay0", "signal", "mutex"};
+
+// Declaration of Task code
+void vBenchTask(void* pvArg);
+void vPingTask(void* pvArg);
+void vPongTask(void* pvArg);
+
+#define BENCH_WORKER_PRIORITY (tskIDLE_PRIORITY + 2)
+
+OSTask <4096> BenchTask(vBenchTask, "Bench", nullptr, BENCH_WORKER_PRIORITY + 2);
+
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <2048> PingTask(vPingTask, "Ping", nullptr, BENCH_WORKER_PRIORITY, OS_MCU_CORE_0);
+OSTask <2048> PongSameCore(vPongTask, "PongSame", nullptr, BENCH_WORKER_PRIORITY, OS_MCU_CORE_0);
+OSTask <2048> PongCrossCore(vPongTask, "PongCross", nullptr, BENCH_WORKER_PRIORITY, OS_MCU_CORE_1);
+#else
+OSTask <2048> PingTask(vPingTask, "Ping", nullptr, BENCH_WORKER_PRIORITY);
+OSTask <2048> PongSameCore(vPongTask, "PongSame", nullptr, BENCH_WORKER_PRIORITY);
+#endif
+
+OSMutex HandoffMutex;
+Counter <1> PingStart;
+Counter <2> WorkersDone;
+
+// Every pong waits on it's own start semaphore: with a shared one kernel
+// wakes the oldest waiter, not the pong selected for the test.
+struct PongContext {
+  OSTaskBase* pxTask;
+  Counter <1>* pxStart;
+};
+
+Counter <1> PongSameStart;
+PongContext PongSameContext = {&PongSameCore, &PongSameStart};
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+Counter <1> PongCrossStart;
+PongContext PongCrossContext = {&PongCrossCore, &PongCrossStart};
+#endif
+
+// Current test shared with workers
+volatile uint8_t activeTest = BENCH_YIELD;
+volatile bool stopPong = false;
+volatile uint32_t elapsedTicks = 0u;
+OSTaskBase* activePong = nullptr;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  HandoffMutex.init();
+  PingStart.init();
+  WorkersDone.init();
+
+  PongSameStart.init();
+  PongSameCore.setArg(reinterpret_cast<void*>(&PongSameContext));
+  PongSameCore.init();
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+  PongCrossStart.init();
+  PongCrossCore.setArg(reinterpret_cast<void*>(&PongCrossContext));
+  PongCrossCore.init();
+#endif
+  PingTask.init();
+  BenchTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+// Ping side: counts iterations and measures time
+void vPingTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    PingStart.take();
+
+    uint32_t start = OSTimestamp::now();
+
+    for (uint32_t i = 0u; i < BENCH_ITERATIONS; i++) {
+      switch (activeTest) {
+        case BENCH_YIELD:
+          OSTask<0>::yield();
+          break;
+
+        case BENCH_DELAY0:
+          OSTask<0>::delay(0);
+          break;
+
+        case BENCH_SIGNAL:
+          activePong->emitSignal();
+          PingTask.waitSignal();
+          break;
+
+        case BENCH_MUTEX:
+          // Pong has higher priority and blocks on the mutex right away,
+          // so unlock() hands it over with inherited priority.
+          HandoffMutex.lock();
+          activePong->emitSignal();
+          HandoffMutex.unlock();
+          PingTask.waitSignal();
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    elapsedTicks = OSTimestamp::now() - start;
+
+    stopPong = true;
+    if ((activeTest == BENCH_SIGNAL) || (activeTest == BENCH_MUTEX)) {
+      activePong->emitSignal();
+    }
+
+    WorkersDone.give();
+  }
+}
+
+// Pong side: answers until stopped
+void vPongTask(void* pvArg)
+{
+  auto context = reinterpret_cast<PongContext*>(pvArg);
+  OSTaskBase* self = context->pxTask;
+
+  for (;;) {
+    context->pxStart->take();
+
+    while (!stopPong) {
+      switch (activeTest) {
+        case BENCH_YIELD:
+          OSTask<0>::yield();
+          break;
+
+        case BENCH_DELAY0:
+          OSTask<0>::delay(0);
+          break;
+
+        case BENCH_SIGNAL:
+          self->waitSignal();
+          if (!stopPong) {
+            PingTask.emitSignal();
+          }
+          break;
+
+        case BENCH_MUTEX:
+          self->waitSignal();
+          if (!stopPong) {
+            HandoffMutex.lock();
+            HandoffMutex.unlock();
+            PingTask.emitSignal();
+          }
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    WorkersDone.give();
+  }
+}
+
+void runTest(uint8_t test, PongContext& pong, const char* placement)
+{
+  activeTest = test;
+  activePong = pong.pxTask;
+  stopPong = false;
+
+  UBaseType_t pongPriority = (test == BENCH_MUTEX) ? (BENCH_WORKER_PRIORITY + 1) : BENCH_WORKER_PRIORITY;
+  vTaskPrioritySet(pong.pxTask->getHandler(), pongPriority);
+
+  pong.pxStart->give();
+  PingStart.give();
+  WorkersDone.take();
+  WorkersDone.take();
+
+  // yield and delay0 make one switch per side, others make one handoff per side
+  uint32_t ops = BENCH_ITERATIONS * 2u;
+  uint32_t ticksPerOp = elapsedTicks / ops;
+
+  Serial.printf("switch,%s,%s,%u,%u,%u\n", testNames[test], placement,
+                (unsigned)BENCH_ITERATIONS, (unsigned)ticksPerOp,
+                (unsigned)(OSTimestamp::toNs(elapsedTicks) / ops));
+}
+
+void vBenchTask([[maybe_unused]] void* pvArg)
+{
+  runTest(BENCH_YIELD, PongSameContext, "same_core");
+  runTest(BENCH_DELAY0, PongSameContext, "same_core");
+  runTest(BENCH_SIGNAL, PongSameContext, "same_core");
+  runTest(BENCH_MUTEX, PongSameContext, "same_core");
+
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+  runTest(BENCH_SIGNAL, PongCrossContext, "cross_core");
+  runTest(BENCH_MUTEX, PongCrossContext, "cross_core");
+#endif
+
+  for (;;) {
+    OSTask<0>::delay(1000);
+  }
+}
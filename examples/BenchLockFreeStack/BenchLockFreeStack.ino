@@ -0,0 +1,230 @@
+#include <stdlib.h>
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+// Host build on POSIX port, fake ISR from the tick joins the stress
+#include "helpers/rtos_helper_isr_sim.hpp"
+#endif
+#include "FreeRTOS_helper.hpp"
+
+// Stress test of OSLockFreeStack as a free list:
+// several unpinned Tasks (so all cores take part) take a few nodes,
+// mark them as owned, check the marks and push them back.
+// Any node handed out twice at the same time is reported as an error.
+// Same loop over a free list guarded by OSCriticalSection is measured as a reference.
+//
+// Every round is printed as CSV line:
+//   lfstack,<impl>,<tasks>,<operations>,<ns_per_op>,<errors>
+// where "impl" is "lock_free" or "critical".
+//
+// Host build (see "Host builds and interleaving tests" in README.md) is a pass/fail test:
+// POSIX port tick preempts Tasks in the middle of CAS loops, and OSIsrSim
+// handler takes a node from the tick on top of that. After STRESS_ROUNDS
+// it prints "lfstack,result,<rounds>,<errors>" and exits with status 1
+// if any node was handed out twice.
+
+#define STRESS_TASKS 4u
+#define STRESS_NODES 8u
+#define STRESS_HELD 3u
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+// Long enough for hundreds of ticks per round,
+// short enough for nanosecond timestamp not to wrap
+#define STRESS_ITERATIONS 200000u
+#define STRESS_ROUNDS 20u
+#else
+#define STRESS_ITERATIONS 20000u
+#endif
+
+typedef struct {
+  volatile uint32_t owner;
+  uint32_t payload;
+} Node;
+
+Node nodes[STRESS_NODES];
+OSLockFreeStack<Node, STRESS_NODES> freeNodes(nodes);
+
+// Reference implementation: plain list under a critical section
+Node* lockedList[STRESS_NODES];
+uint32_t lockedCount = 0u;
+OSCriticalSection listLock;
+
+volatile bool useLockFree = true;
+OSAtomic<uint32_t> errorsCount;
+uint32_t totalErrors = 0u;
+
+// Declaration of Task code
+void vStressTask(void* pvArg);
+void vBenchTask(void* pvArg);
+
+OSTask <2048> StressTasks[STRESS_TASKS] = {
+  {vStressTask, "Stress0", nullptr, tskIDLE_PRIORITY + 1},
+  {vStressTask, "Stress1", nullptr, tskIDLE_PRIORITY + 1},
+  {vStressTask, "Stress2", nullptr, tskIDLE_PRIORITY + 1},
+  {vStressTask, "Stress3", nullptr, tskIDLE_PRIORITY + 1},
+};
+OSTask <2048> BenchTask(vBenchTask, "Bench", nullptr, tskIDLE_PRIORITY + 2);
+
+Counter <STRESS_TASKS> StressDone;
+
+Node* takeNode(void)
+{
+  if (useLockFree) {
+    return freeNodes.pop();
+  }
+
+  Node* node = nullptr;
+  auto status = listLock.enter();
+  if (lockedCount != 0u) {
+    node = lockedList[--lockedCount];
+  }
+  listLock.exit(status);
+  return node;
+}
+
+void giveNode(Node* node)
+{
+  if (useLockFree) {
+    freeNodes.push(node);
+    return;
+  }
+
+  auto status = listLock.enter();
+  lockedList[lockedCount++] = node;
+  listLock.exit(status);
+}
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+// Interrupts a Task at random point, possibly between load and CAS of the head
+void onStressIsr([[maybe_unused]] void* pvArg)
+{
+  Node* node = takeNode();
+  if (node == nullptr) {
+    return;
+  }
+  // Nothing runs until handler returns, so only check it's free
+  if (node->owner != 0u) {
+    errorsCount.fetchAdd(1u);
+  }
+  giveNode(node);
+}
+
+extern "C" void vApplicationTickHook(void)
+{
+  OSIsrSim::tickHook();
+}
+#endif
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  StressDone.init();
+
+  freeNodes.fill();
+  for (uint32_t i = 0u; i < STRESS_NODES; i++) {
+    lockedList[lockedCount++] = &nodes[i];
+  }
+
+  for (uint32_t i = 0u; i < STRESS_TASKS; i++) {
+    StressTasks[i].setArg(reinterpret_cast<void*>(&StressTasks[i]));
+    StressTasks[i].init();
+  }
+  BenchTask.init();
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+  OSCriticalSection lock;
+  auto status = lock.enter();
+  OSIsrSim::attach(onStressIsr);
+  lock.exit(status);
+#endif
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vStressTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+  const uint32_t id = (uint32_t)(reinterpret_cast<uintptr_t>(self) & 0xFFFFFFu) | 1u;
+  Node* held[STRESS_HELD];
+
+  for (;;) {
+    self->waitSignal();
+
+    for (uint32_t i = 0u; i < STRESS_ITERATIONS; i++) {
+      uint32_t count = 0u;
+
+      for (; count < STRESS_HELD; count++) {
+        held[count] = takeNode();
+        if (held[count] == nullptr) {
+          break;
+        }
+        if (held[count]->owner != 0u) {
+          errorsCount.fetchAdd(1u);
+        }
+        held[count]->owner = id;
+        held[count]->payload = i;
+      }
+
+      while (count != 0u) {
+        Node* node = held[--count];
+        if ((node->owner != id) || (node->payload != i)) {
+          errorsCount.fetchAdd(1u);
+        }
+        node->owner = 0u;
+        giveNode(node);
+      }
+    }
+
+    StressDone.give();
+  }
+}
+
+void runRound(bool lockFree)
+{
+  useLockFree = lockFree;
+  errorsCount.store(0u);
+
+  uint32_t start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < STRESS_TASKS; i++) {
+    StressTasks[i].emitSignal();
+  }
+  for (uint32_t i = 0u; i < STRESS_TASKS; i++) {
+    StressDone.take();
+  }
+  uint32_t elapsed = OSTimestamp::now() - start;
+
+  // Every iteration is up to STRESS_HELD pops and the same amount of pushes
+  const uint32_t operations = STRESS_TASKS * STRESS_ITERATIONS * STRESS_HELD * 2u;
+  Serial.printf("lfstack,%s,%u,%u,%u,%u\n", lockFree ? "lock_free" : "critical",
+                (unsigned)STRESS_TASKS, (unsigned)operations,
+                (unsigned)(OSTimestamp::toNs(elapsed) / operations), (unsigned)errorsCount.load());
+
+  totalErrors += errorsCount.load();
+}
+
+void vBenchTask([[maybe_unused]] void* pvArg)
+{
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+  for (uint32_t round = 0u; round < STRESS_ROUNDS; round++) {
+    runRound(true);
+    runRound(false);
+  }
+
+  Serial.printf("lfstack,result,%u,%u\n", (unsigned)STRESS_ROUNDS, (unsigned)totalErrors);
+  exit((totalErrors == 0u) ? EXIT_SUCCESS : EXIT_FAILURE);
+#endif
+
+  for (;;) {
+    runRound(true);
+    runRound(false);
+    OSTask<0>::delay(1000);
+  }
+}
@@ -0,0 +1,537 @@
+#include "FreeRTOS_helper.hpp"
+
+// Throughput matrix of inter-Task channels:
+//  - osqueue: OSQueue, items are copied through the kernel queue;
+//  - lfring: OSLockFreeRing, lock-free MPMC ring, polled;
+//  - bip: OSBipBuffer, lock-free SPSC, fixed-size records, polled;
+//  - pool: OSBufferPool segments passed by pointer through OSQueue;
+//  - item sizes: 1, 16, 64, 256 and 1024 bytes;
+//  - depths: 1, 16, 128 and 1024 items (skipped if it does not fit BENCH_MAX_QUEUE_BYTES
+//    or channel with its bookkeeping does not fit BENCH_ARENA_BYTES);
+//  - 1..BENCH_MAX_TASKS producers and consumers (bip only 1 and 1);
+//  - Task senders and (on ESP32) hardware timer ISR sender.
+// Every channel copies an item once on send and once on receive,
+// non-blocking ones yield between attempts while waiting.
+//
+// Every case is printed as CSV line:
+//   queue,<impl>,<item_bytes>,<depth>,<producers>,<consumers>,<sender_ctx>,<items_per_s>,<bytes_per_s>
+// At the end of the run recommendation table is printed,
+// with the fastest measured channel and its configuration for every item size,
+// separately for single producer and consumer ("spsc") and for the rest ("mpmc"):
+//   recommend,<topology>,<impl>,<item_bytes>,<depth>,<producers>,<consumers>,<items_per_s>,<min_depth_90>
+// where "min_depth_90" is the smallest depth of that channel reaching 90% of its best throughput.
+//
+// Other channel types can be added to the matrix through BenchOps.
+
+#include <new>
+
+// Amount of items passed in every case
+#define BENCH_ITEMS_PER_CASE 2000u
+// Max amount of producers and consumers (1..4)
+#define BENCH_MAX_TASKS 4u
+// Max RAM for a single queue storage
+#define BENCH_MAX_QUEUE_BYTES 16384u
+// RAM for the channel under test with its bookkeeping, shared by all cases
+#define BENCH_ARENA_BYTES (2u * BENCH_MAX_QUEUE_BYTES + 4096u)
+// Period of ISR sender in microseconds
+#define BENCH_ISR_PERIOD_US 100u
+
+// Channel types, index of BenchOps::implIndex
+#define BENCH_IMPL_COUNT 4u
+const char* const implNames[BENCH_IMPL_COUNT] = {"osqueue", "lfring", "bip", "pool"};
+
+template <size_t ItemSize> struct BenchItem {
+  uint8_t data[ItemSize];
+};
+
+// Type erased access to the channel under test
+struct BenchOps {
+  uint32_t implIndex;
+  bool (*send)(const uint8_t* item, size_t xMsToWait);
+  bool (*receive)(uint8_t* item, size_t xMsToWait);
+  void (*destroy)(void);
+  size_t itemSize;
+  size_t depth;
+  uint32_t maxProducers;
+  uint32_t maxConsumers;
+};
+
+// Channel under test is created here and destroyed after its cases,
+// so RAM does not grow with the matrix
+alignas(8) uint8_t benchArena[BENCH_ARENA_BYTES];
+
+template <class Channel> Channel& arenaChannel()
+{
+  return *reinterpret_cast<Channel*>(benchArena);
+}
+
+// Non-blocking channels are polled, other workers run in between
+template <class Attempt> bool pollFor(Attempt attempt, size_t xMsToWait)
+{
+  uint32_t startMs = millis();
+
+  for (;;) {
+    if (attempt()) {
+      return true;
+    }
+    if ((xMsToWait != portMAX_DELAY_MS) && ((millis() - startMs) >= xMsToWait)) {
+      return false;
+    }
+    OSTask<0>::yield();
+  }
+}
+
+template <size_t ItemSize, size_t Depth> struct BenchQueueCase {
+  typedef BenchItem<ItemSize> Item;
+  typedef OSQueue<Depth, Item> Channel;
+
+  static bool send(const uint8_t* item, size_t xMsToWait)
+  {
+    return arenaChannel<Channel>().send(reinterpret_cast<const Item*>(item), xMsToWait);
+  }
+
+  static bool receive(uint8_t* item, size_t xMsToWait)
+  {
+    return arenaChannel<Channel>().receive(reinterpret_cast<Item*>(item), xMsToWait);
+  }
+
+  static void destroy(void)
+  {
+    arenaChannel<Channel>().~Channel();
+  }
+
+  static BenchOps create()
+  {
+    // created before any producer or consumer will touch it
+    new (benchArena) Channel();
+    arenaChannel<Channel>().init();
+    return {0u, send, receive, destroy, ItemSize, Depth, BENCH_MAX_TASKS, BENCH_MAX_TASKS};
+  }
+};
+
+template <size_t ItemSize, size_t Depth> struct BenchRingCase {
+  typedef BenchItem<ItemSize> Item;
+  typedef OSLockFreeRing<Item, Depth> Channel;
+
+  static bool send(const uint8_t* item, size_t xMsToWait)
+  {
+    return pollFor([&]() { return arenaChannel<Channel>().push(*reinterpret_cast<const Item*>(item)); },
+                   xMsToWait);
+  }
+
+  static bool receive(uint8_t* item, size_t xMsToWait)
+  {
+    return pollFor([&]() { return arenaChannel<Channel>().pop(*reinterpret_cast<Item*>(item)); }, xMsToWait);
+  }
+
+  static void destroy(void)
+  {
+    arenaChannel<Channel>().~Channel();
+  }
+
+  static BenchOps create()
+  {
+    new (benchArena) Channel();
+    return {1u, send, receive, destroy, ItemSize, Depth, BENCH_MAX_TASKS, BENCH_MAX_TASKS};
+  }
+};
+
+template <size_t ItemSize, size_t Depth> struct BenchBipCase {
+  // One byte more, otherwise full buffer would look empty
+  typedef OSBipBuffer<ItemSize * Depth + 1u> Channel;
+
+  static bool send(const uint8_t* item, size_t xMsToWait)
+  {
+    return pollFor([&]() {
+      uint8_t* p = arenaChannel<Channel>().reserve(ItemSize);
+      if (p == nullptr) {
+        return false;
+      }
+      memcpy(p, item, ItemSize);
+      arenaChannel<Channel>().commit(ItemSize);
+      return true;
+    }, xMsToWait);
+  }
+
+  static bool receive(uint8_t* item, size_t xMsToWait)
+  {
+    return pollFor([&]() {
+      // Records are never split, so any span holds whole items
+      uint32_t size;
+      uint8_t* p = arenaChannel<Channel>().read(size);
+      if (p == nullptr) {
+        return false;
+      }
+      memcpy(item, p, ItemSize);
+      arenaChannel<Channel>().release(ItemSize);
+      return true;
+    }, xMsToWait);
+  }
+
+  static void destroy(void)
+  {
+    arenaChannel<Channel>().~Channel();
+  }
+
+  static BenchOps create()
+  {
+    new (benchArena) Channel();
+    return {2u, send, receive, destroy, ItemSize, Depth, 1u, 1u};
+  }
+};
+
+template <size_t ItemSize, size_t Depth> struct BenchPoolChannel {
+  // Every worker may hold one segment besides the queued ones
+  OSBufferPool<ItemSize, Depth + 2u * BENCH_MAX_TASKS> segments;
+  OSQueue<Depth, os_buf_segment_t*> queue;
+};
+
+template <size_t ItemSize, size_t Depth> struct BenchPoolCase {
+  typedef BenchPoolChannel<ItemSize, Depth> Channel;
+
+  static bool send(const uint8_t* item, size_t xMsToWait)
+  {
+    Channel& channel = arenaChannel<Channel>();
+    os_buf_segment_t* pxSegment = nullptr;
+
+    if (!pollFor([&]() { return (pxSegment = channel.segments.alloc()) != nullptr; }, xMsToWait)) {
+      return false;
+    }
+
+    memcpy(OSBufferPoolBase::getData(pxSegment), item, ItemSize);
+    pxSegment->usLength = ItemSize;
+
+    if (!channel.queue.send(pxSegment, xMsToWait)) {
+      channel.segments.free(pxSegment);
+      return false;
+    }
+    return true;
+  }
+
+  static bool receive(uint8_t* item, size_t xMsToWait)
+  {
+    Channel& channel = arenaChannel<Channel>();
+    os_buf_segment_t* pxSegment;
+
+    if (!channel.queue.receive(pxSegment, xMsToWait)) {
+      return false;
+    }
+
+    memcpy(item, OSBufferPoolBase::getData(pxSegment), ItemSize);
+    channel.segments.free(pxSegment);
+    return true;
+  }
+
+  static void destroy(void)
+  {
+    arenaChannel<Channel>().~Channel();
+  }
+
+  static BenchOps create()
+  {
+    new (benchArena) Channel();
+    arenaChannel<Channel>().queue.init();
+    return {3u, send, receive, destroy, ItemSize, Depth, BENCH_MAX_TASKS, BENCH_MAX_TASKS};
+  }
+};
+
+// Declaration of Task code
+void vBenchTask(void* pvArg);
+void vProducerTask(void* pvArg);
+void vConsumerTask(void* pvArg);
+
+OSTask <4096> BenchTask(vBenchTask, "Bench", nullptr, tskIDLE_PRIORITY + 3);
+
+OSTask <2048> Producers[] = {
+  {vProducerTask, "Prod0", nullptr, tskIDLE_PRIORITY + 2},
+  {vProducerTask, "Prod1", nullptr, tskIDLE_PRIORITY + 2},
+  {vProducerTask, "Prod2", nullptr, tskIDLE_PRIORITY + 2},
+  {vProducerTask, "Prod3", nullptr, tskIDLE_PRIORITY + 2},
+};
+
+OSTask <2048> Consumers[] = {
+  {vConsumerTask, "Cons0", nullptr, tskIDLE_PRIORITY + 2},
+  {vConsumerTask, "Cons1", nullptr, tskIDLE_PRIORITY + 2},
+  {vConsumerTask, "Cons2", nullptr, tskIDLE_PRIORITY + 2},
+  {vConsumerTask, "Cons3", nullptr, tskIDLE_PRIORITY + 2},
+};
+
+// Given by every worker when it's done with current case
+Counter <2 * BENCH_MAX_TASKS> WorkersIdle;
+
+// Current case shared with workers
+BenchOps currentOps;
+volatile uint32_t producerQuota = 0u;
+volatile uint32_t itemsTotal = 0u;
+volatile uint32_t itemsReceived = 0u;
+
+// Best result of every channel type, per item size and topology
+struct BenchBest {
+  size_t itemSize;
+  size_t depth;
+  uint32_t producers;
+  uint32_t consumers;
+  uint32_t itemsPerSec;
+  size_t depthsSeen[4];
+  uint32_t depthsRate[4];
+  uint32_t depthsCount;
+};
+
+// Topology: 0 - single producer and consumer, 1 - the rest
+#define BENCH_TOPOLOGY_COUNT 2u
+const char* const topologyNames[BENCH_TOPOLOGY_COUNT] = {"spsc", "mpmc"};
+
+BenchBest bestResults[5][BENCH_TOPOLOGY_COUNT][BENCH_IMPL_COUNT];
+uint32_t bestIndex = 0u;
+
+#if defined(ESP32)
+hw_timer_t* senderTimer = nullptr;
+volatile uint32_t isrQuota = 0u;
+
+void IRAM_ATTR onSenderTimer()
+{
+  static uint8_t item[1024];
+
+  // Push as much as possible without blocking
+  while ((isrQuota != 0u) && currentOps.send(item, 0u)) {
+    isrQuota--;
+  }
+}
+
+void startSenderTimer()
+{
+#if (ESP_ARDUINO_VERSION_MAJOR >= 3)
+  senderTimer = timerBegin(1000000u); // 1MHz
+  timerAttachInterrupt(senderTimer, &onSenderTimer);
+  timerAlarm(senderTimer, BENCH_ISR_PERIOD_US, true, 0u);
+#else
+  senderTimer = timerBegin(0, 80, true); // 1MHz
+  timerAttachInterrupt(senderTimer, &onSenderTimer, true);
+  timerAlarmWrite(senderTimer, BENCH_ISR_PERIOD_US, true);
+  timerAlarmEnable(senderTimer);
+#endif
+}
+#endif
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  WorkersIdle.init();
+
+  for (uint32_t i = 0u; i < BENCH_MAX_TASKS; i++) {
+    Producers[i].setArg(reinterpret_cast<void*>(&Producers[i]));
+    Producers[i].init();
+    Consumers[i].setArg(reinterpret_cast<void*>(&Consumers[i]));
+    Consumers[i].init();
+  }
+
+  BenchTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vProducerTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+  uint8_t item[1024] = {0};
+
+  for (;;) {
+    self->waitSignal();
+
+    for (uint32_t i = 0u; i < producerQuota; i++) {
+      item[0] = (uint8_t)i;
+      currentOps.send(item, portMAX_DELAY_MS);
+    }
+
+    WorkersIdle.give();
+  }
+}
+
+void vConsumerTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+  uint8_t item[1024];
+
+  for (;;) {
+    self->waitSignal();
+
+    while (__atomic_load_n(&itemsReceived, __ATOMIC_RELAXED) < itemsTotal) {
+      if (currentOps.receive(item, 1u)) {
+        __atomic_add_fetch(&itemsReceived, 1u, __ATOMIC_RELAXED);
+      }
+    }
+
+    WorkersIdle.give();
+  }
+}
+
+uint32_t runCase(const BenchOps& ops, uint32_t producers, uint32_t consumers, bool isrSender)
+{
+  currentOps = ops;
+  itemsTotal = (BENCH_ITEMS_PER_CASE / producers) * producers;
+  producerQuota = itemsTotal / producers;
+  itemsReceived = 0u;
+
+  uint32_t startUs = micros();
+
+#if defined(ESP32)
+  if (isrSender) {
+    producers = 0u;
+    isrQuota = itemsTotal;
+  }
+#endif
+
+  for (uint32_t i = 0u; i < producers; i++) {
+    Producers[i].emitSignal();
+  }
+  for (uint32_t i = 0u; i < consumers; i++) {
+    Consumers[i].emitSignal();
+  }
+  for (uint32_t i = 0u; i < (producers + consumers); i++) {
+    WorkersIdle.take();
+  }
+
+  uint32_t elapsedUs = micros() - startUs;
+  if (elapsedUs == 0u) {
+    elapsedUs = 1u;
+  }
+
+  uint32_t itemsPerSec = (uint32_t)(((uint64_t)itemsTotal * 1000000ULL) / elapsedUs);
+
+  Serial.printf("queue,%s,%u,%u,%u,%u,%s,%u,%u\n",
+                implNames[ops.implIndex], (unsigned)ops.itemSize, (unsigned)ops.depth,
+                (unsigned)(isrSender ? 1u : producers), (unsigned)consumers,
+                isrSender ? "isr" : "task",
+                (unsigned)itemsPerSec, (unsigned)(itemsPerSec * ops.itemSize));
+
+  return itemsPerSec;
+}
+
+void recordBest(const BenchOps& ops, uint32_t producers, uint32_t consumers, uint32_t itemsPerSec)
+{
+  uint32_t topology = ((producers == 1u) && (consumers == 1u)) ? 0u : 1u;
+  BenchBest& best = bestResults[bestIndex][topology][ops.implIndex];
+  best.itemSize = ops.itemSize;
+
+  if (itemsPerSec > best.itemsPerSec) {
+    best.itemsPerSec = itemsPerSec;
+    best.depth = ops.depth;
+    best.producers = producers;
+    best.consumers = consumers;
+  }
+
+  // Keep the best rate reached by every depth
+  uint32_t i = 0u;
+  for (; i < best.depthsCount; i++) {
+    if (best.depthsSeen[i] == ops.depth) {
+      break;
+    }
+  }
+  if (i == best.depthsCount) {
+    best.depthsSeen[i] = ops.depth;
+    best.depthsRate[i] = 0u;
+    best.depthsCount++;
+  }
+  if (itemsPerSec > best.depthsRate[i]) {
+    best.depthsRate[i] = itemsPerSec;
+  }
+}
+
+template <class Case> void runChannel()
+{
+  if constexpr (sizeof(typename Case::Channel) <= BENCH_ARENA_BYTES) {
+    BenchOps ops = Case::create();
+
+    for (uint32_t producers = 1u; producers <= ops.maxProducers; producers++) {
+      for (uint32_t consumers = 1u; consumers <= ops.maxConsumers; consumers++) {
+        uint32_t rate = runCase(ops, producers, consumers, false);
+        recordBest(ops, producers, consumers, rate);
+      }
+    }
+
+#if defined(ESP32)
+    runCase(ops, 1u, 1u, true);
+#endif
+
+    ops.destroy();
+  }
+}
+
+template <size_t ItemSize, size_t Depth> void runDepth()
+{
+  if constexpr ((ItemSize * Depth) <= BENCH_MAX_QUEUE_BYTES) {
+    runChannel<BenchQueueCase<ItemSize, Depth>>();
+    runChannel<BenchRingCase<ItemSize, Depth>>();
+    runChannel<BenchBipCase<ItemSize, Depth>>();
+    runChannel<BenchPoolCase<ItemSize, Depth>>();
+  }
+}
+
+template <size_t ItemSize> void runItemSize()
+{
+  runDepth<ItemSize, 1>();
+  runDepth<ItemSize, 16>();
+  runDepth<ItemSize, 128>();
+  runDepth<ItemSize, 1024>();
+  bestIndex++;
+}
+
+void printRecommendations()
+{
+  for (uint32_t i = 0u; i < bestIndex; i++) {
+    for (uint32_t topology = 0u; topology < BENCH_TOPOLOGY_COUNT; topology++) {
+      // Pick the fastest channel type measured for this item size and topology
+      uint32_t winner = BENCH_IMPL_COUNT;
+      for (uint32_t impl = 0u; impl < BENCH_IMPL_COUNT; impl++) {
+        const BenchBest& best = bestResults[i][topology][impl];
+        if ((best.itemsPerSec != 0u) &&
+            ((winner == BENCH_IMPL_COUNT) || (best.itemsPerSec > bestResults[i][topology][winner].itemsPerSec))) {
+          winner = impl;
+        }
+      }
+      if (winner == BENCH_IMPL_COUNT) {
+        continue; // nothing fit
+      }
+
+      const BenchBest& best = bestResults[i][topology][winner];
+
+      size_t minDepth = best.depth;
+      for (uint32_t d = 0u; d < best.depthsCount; d++) {
+        if ((best.depthsRate[d] >= (best.itemsPerSec / 10u) * 9u) && (best.depthsSeen[d] < minDepth)) {
+          minDepth = best.depthsSeen[d];
+        }
+      }
+
+      Serial.printf("recommend,%s,%s,%u,%u,%u,%u,%u,%u\n", topologyNames[topology], implNames[winner],
+                    (unsigned)best.itemSize, (unsigned)best.depth,
+                    (unsigned)best.producers, (unsigned)best.consumers,
+                    (unsigned)best.itemsPerSec, (unsigned)minDepth);
+    }
+  }
+}
+
+void vBenchTask([[maybe_unused]] void* pvArg)
+{
+#if defined(ESP32)
+  startSenderTimer();
+#endif
+
+  runItemSize<1>();
+  runItemSize<16>();
+  runItemSize<64>();
+  runItemSize<256>();
+  runItemSize<1024>();
+
+  printRecommendations();
+
+  for (;;) {
+    OSTask<0>::delay(1000);
+  }
+}
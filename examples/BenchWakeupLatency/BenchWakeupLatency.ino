@@ -0,0 +1,242 @@
+#include <stdlib.h>
+
+#if defined(OS_HELPER_VANILLA_FREERTOS)
+// Host build on POSIX port, trigger is a fake ISR from the tick
+#include "helpers/rtos_helper_isr_sim.hpp"
+#endif
+#include "FreeRTOS_helper.hpp"
+
+// Benchmark of ISR-to-Task wake-up latency for every signalling primitive:
+//  - OSTask::emitSignal() (direct task notification);
+//  - Counter::give() (counting semaphore);
+//  - OSQueue::send();
+//  - Counter<1>::give() (binary semaphore, same kernel object layout).
+//
+// Results are printed as CSV lines, one per primitive:
+//   latency,<primitive>,<load_tasks>,<trigger_ctx>,<samples>,<p50_ns>,<p99_ns>,<max_ns>
+// so they can be grepped from the log and tracked between builds.
+//
+// On ESP32 trigger is a hardware timer interrupt.
+// In host builds (see "Host builds and interleaving tests" in README.md) it's OSIsrSim handler
+// executed from the POSIX port tick, so "trigger_ctx" is "isr_sim".
+// On other MCU it's the highest priority Task (so "trigger_ctx" is "task").
+
+// Amount of measurements per primitive
+#define BENCH_SAMPLES 1000u
+// Amount of lower priority Tasks generating background load (0..4)
+#define BENCH_LOAD_TASKS 2u
+// Period of trigger in microseconds
+#define BENCH_TRIGGER_PERIOD_US 1000u
+
+enum {
+  BENCH_NOTIFY = 0,
+  BENCH_COUNTER,
+  BENCH_QUEUE,
+  BENCH_BINARY_SEM,
+  BENCH_PRIMITIVES_COUNT
+};
+
+const char* primitiveNames[BENCH_PRIMITIVES_COUNT] = {
+  "task_notify", "counter", "queue", "binary_sem"
+};
+
+// Declaration of Task code
+void vWaiterTask(void* pvArg);
+void vLoadTask(void* pvArg);
+
+// Waiter must stay on the same core as trigger interrupt,
+// as cycle counters of different cores are not synchronised.
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <2048> WaiterTask(vWaiterTask, "Waiter", nullptr, configMAX_PRIORITIES - 2, OS_MCU_CORE_1);
+#else
+OSTask <2048> WaiterTask(vWaiterTask, "Waiter", nullptr, configMAX_PRIORITIES - 2);
+#endif
+
+// Background load, only first BENCH_LOAD_TASKS are started
+OSTask <1024> LoadTasks[] = {
+  {vLoadTask, "Load0", nullptr, tskIDLE_PRIORITY + 1},
+  {vLoadTask, "Load1", nullptr, tskIDLE_PRIORITY + 1},
+  {vLoadTask, "Load2", nullptr, tskIDLE_PRIORITY + 1},
+  {vLoadTask, "Load3", nullptr, tskIDLE_PRIORITY + 1},
+};
+
+Counter <16> WakeCounter;
+Counter <1> WakeBinarySem;
+OSQueue <1, uint32_t> WakeQueue;
+OSQueue <4, uint32_t> LoadQueue;
+
+// Shared between trigger and waiter
+volatile uint32_t triggerStamp = 0u;
+volatile uint8_t activePrimitive = BENCH_NOTIFY;
+volatile bool triggerArmed = false;
+
+uint32_t samples[BENCH_SAMPLES];
+
+// Trigger code, executed in ISR or in the highest priority Task
+#if defined(ESP32)
+void IRAM_ATTR onTrigger()
+#else
+void onTrigger()
+#endif
+{
+  if (!triggerArmed) {
+    return;
+  }
+  triggerArmed = false;
+
+  uint32_t stamp = OSTimestamp::now();
+  triggerStamp = stamp;
+
+  switch (activePrimitive) {
+    case BENCH_NOTIFY:     WaiterTask.emitSignal(); break;
+    case BENCH_COUNTER:    WakeCounter.give(); break;
+    case BENCH_QUEUE:      WakeQueue.send(stamp, 0u); break;
+    case BENCH_BINARY_SEM: WakeBinarySem.give(); break;
+    default: break;
+  }
+}
+
+#if defined(ESP32)
+const char* triggerContext = "isr";
+hw_timer_t* triggerTimer = nullptr;
+
+void startTrigger()
+{
+#if (ESP_ARDUINO_VERSION_MAJOR >= 3)
+  triggerTimer = timerBegin(1000000u); // 1MHz
+  timerAttachInterrupt(triggerTimer, &onTrigger);
+  timerAlarm(triggerTimer, BENCH_TRIGGER_PERIOD_US, true, 0u);
+#else
+  triggerTimer = timerBegin(0, 80, true); // 1MHz
+  timerAttachInterrupt(triggerTimer, &onTrigger, true);
+  timerAlarmWrite(triggerTimer, BENCH_TRIGGER_PERIOD_US, true);
+  timerAlarmEnable(triggerTimer);
+#endif
+}
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+const char* triggerContext = "isr_sim";
+
+void onTriggerIsr([[maybe_unused]] void* pvArg)
+{
+  onTrigger();
+}
+
+extern "C" void vApplicationTickHook(void)
+{
+  OSIsrSim::tickHook();
+}
+
+void startTrigger()
+{
+  // Resolution is limited by tick period
+  TickType_t xPeriod = pdMS_TO_TICKS(BENCH_TRIGGER_PERIOD_US / 1000u);
+  OSCriticalSection lock;
+
+  auto uxStatus = lock.enter();
+  OSIsrSim::attach(onTriggerIsr, nullptr, (xPeriod != 0u) ? xPeriod : 1u);
+  lock.exit(uxStatus);
+}
+#else
+const char* triggerContext = "task";
+
+void vTriggerTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    OSTask<0>::delay(BENCH_TRIGGER_PERIOD_US / 1000u);
+    onTrigger();
+  }
+}
+
+OSTask <1024> TriggerTask(vTriggerTask, "Trigger", nullptr, configMAX_PRIORITIES - 1);
+
+void startTrigger()
+{
+  TriggerTask.init();
+}
+#endif
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  WakeCounter.init();
+  WakeBinarySem.init();
+  WakeQueue.init();
+  LoadQueue.init();
+
+  for (uint32_t i = 0u; i < BENCH_LOAD_TASKS; i++) {
+    LoadTasks[i].init();
+  }
+
+  WaiterTask.init();
+  startTrigger();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+int compareSamples(const void* a, const void* b)
+{
+  uint32_t x = *reinterpret_cast<const uint32_t*>(a);
+  uint32_t y = *reinterpret_cast<const uint32_t*>(b);
+  return (x > y) - (x < y);
+}
+
+void waitForPrimitive(uint8_t primitive)
+{
+  uint32_t dummy = 0u;
+
+  switch (primitive) {
+    case BENCH_NOTIFY:     WaiterTask.waitSignal(); break;
+    case BENCH_COUNTER:    WakeCounter.take(); break;
+    case BENCH_QUEUE:      WakeQueue.receive(dummy); break;
+    case BENCH_BINARY_SEM: WakeBinarySem.take(); break;
+    default: break;
+  }
+}
+
+void vWaiterTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    for (uint8_t primitive = 0u; primitive < BENCH_PRIMITIVES_COUNT; primitive++) {
+      activePrimitive = primitive;
+
+      for (uint32_t i = 0u; i < BENCH_SAMPLES; i++) {
+        triggerArmed = true;
+        waitForPrimitive(primitive);
+        samples[i] = (uint32_t)OSTimestamp::toNs(OSTimestamp::now() - triggerStamp);
+      }
+
+      qsort(samples, BENCH_SAMPLES, sizeof(samples[0]), compareSamples);
+
+      Serial.printf("latency,%s,%u,%s,%u,%u,%u,%u\n",
+                    primitiveNames[primitive], (unsigned)BENCH_LOAD_TASKS, triggerContext,
+                    (unsigned)BENCH_SAMPLES,
+                    (unsigned)samples[BENCH_SAMPLES / 2u],
+                    (unsigned)samples[(BENCH_SAMPLES * 99u) / 100u],
+                    (unsigned)samples[BENCH_SAMPLES - 1u]);
+    }
+
+    OSTask<0>::delay(5000);
+  }
+}
+
+// Load Tasks are constantly passing items through the Queue,
+// so kernel spends some time in critical sections.
+void vLoadTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t item = 0u;
+
+  for (;;) {
+    LoadQueue.send(item);
+    LoadQueue.receive(item);
+    item++;
+  }
+}
@@ -0,0 +1,102 @@
+#include "FreeRTOS_helper.hpp"
+
+// Variable-length frames with no copies:
+// Framer writes every frame right into the bip-buffer,
+// Parser gets them back as contiguous spans and wakes up on every commit.
+//
+// Status is printed as CSV lines every second:
+//   bip,<frames>,<bytes>,<dropped>
+
+#define FRAME_HEADER_SIZE 2u
+#define FRAME_PAYLOAD_MAX 120u
+
+OSBipBuffer<1024> Frames;
+
+// Declaration of Task code
+void vFramerTask(void* pvArg);
+void vParserTask(void* pvArg);
+
+OSTask <2048> FramerTask(vFramerTask, "Framer", nullptr, tskIDLE_PRIORITY + 1);
+OSTask <2048> ParserTask(vParserTask, "Parser", nullptr, tskIDLE_PRIORITY + 2);
+
+volatile uint32_t droppedCount = 0u;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  FramerTask.init();
+  ParserTask.init();
+
+  Frames.setConsumer(&ParserTask);
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vFramerTask([[maybe_unused]] void* pvArg)
+{
+  uint16_t seq = 0u;
+  uint32_t rnd = 1u;
+
+  for (;;) {
+    OSTask<0>::delay(2);
+
+    // Reserve for the worst case, commit only what was really written
+    uint8_t* p = Frames.reserve(FRAME_HEADER_SIZE + FRAME_PAYLOAD_MAX);
+    if (p == nullptr) {
+      droppedCount++;
+      continue;
+    }
+
+    rnd = rnd * 1103515245u + 12345u;
+    uint16_t len = 1u + (uint16_t)((rnd >> 16) % FRAME_PAYLOAD_MAX);
+    for (uint16_t i = 0u; i < len; i++) {
+      p[FRAME_HEADER_SIZE + i] = (uint8_t)(seq + i);
+    }
+    memcpy(p, &len, FRAME_HEADER_SIZE);
+
+    Frames.commit(FRAME_HEADER_SIZE + len);
+    seq++;
+  }
+}
+
+void vParserTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t framesCount = 0u;
+  uint32_t bytesCount = 0u;
+  uint32_t lastPrint = millis();
+
+  for (;;) {
+    ParserTask.waitSignal(100);
+
+    uint32_t size;
+    uint8_t* data;
+    // Two spans at most: the end of the buffer and its start
+    while ((data = Frames.read(size)) != nullptr) {
+      uint32_t offset = 0u;
+
+      while (offset < size) {
+        uint16_t len;
+        memcpy(&len, &data[offset], FRAME_HEADER_SIZE);
+        // Payload is handled in place at &data[offset + FRAME_HEADER_SIZE]
+        offset += FRAME_HEADER_SIZE + len;
+        framesCount++;
+        bytesCount += len;
+      }
+
+      Frames.release(size);
+    }
+
+    if ((millis() - lastPrint) >= 1000u) {
+      lastPrint = millis();
+      Serial.printf("bip,%u,%u,%u\n", (unsigned)framesCount, (unsigned)bytesCount,
+                    (unsigned)droppedCount);
+    }
+  }
+}
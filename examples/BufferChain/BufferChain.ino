@@ -0,0 +1,153 @@
+#include "FreeRTOS_helper.hpp"
+
+// Frames passed through a stack of Tasks with no reassembly:
+// Radio appends received payload, Router strips radio header and adds
+// its own one in the headroom, App gathers the payload.
+// Only a pointer to the first segment goes through every Queue.
+//
+// Status is printed as CSV lines every second:
+//   chain,<frames>,<bytes>,<dropped>,<free_segments>
+
+#define PAYLOAD_MAX 300u
+
+typedef struct {
+  uint8_t channel;
+  int8_t rssi;
+} RadioHeader;
+
+typedef struct {
+  uint16_t route;
+  uint16_t length;
+} RouteHeader;
+
+// 128 bytes per segment, 16 bytes of headroom for headers
+OSBufferPool<128, 32, 16> Segments;
+
+OSQueue<8, os_buf_segment_t*> toRouter;
+OSQueue<8, os_buf_segment_t*> toApp;
+
+// Declaration of Task code
+void vRadioTask(void* pvArg);
+void vRouterTask(void* pvArg);
+void vAppTask(void* pvArg);
+
+OSTask <2048> RadioTask(vRadioTask, "Radio", nullptr, tskIDLE_PRIORITY + 3);
+OSTask <2048> RouterTask(vRouterTask, "Router", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <4096> AppTask(vAppTask, "App", nullptr, tskIDLE_PRIORITY + 1);
+
+volatile uint32_t droppedCount = 0u;
+
+// Chain which could not be passed further is freed with the segments
+void forward(OSQueue<8, os_buf_segment_t*>& queue, OSBufferChain& frame)
+{
+  os_buf_segment_t* head = frame.detach();
+  if (!queue.send(head, 0)) {
+    Segments.free(head);
+    droppedCount++;
+  }
+}
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  toRouter.init();
+  toApp.init();
+
+  RadioTask.init();
+  RouterTask.init();
+  AppTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vRadioTask([[maybe_unused]] void* pvArg)
+{
+  uint8_t rx[PAYLOAD_MAX];
+  uint32_t rnd = 1u;
+
+  for (;;) {
+    OSTask<0>::delay(10);
+
+    // Something received by the radio
+    rnd = rnd * 1103515245u + 12345u;
+    uint32_t len = 1u + ((rnd >> 16) % PAYLOAD_MAX);
+    for (uint32_t i = 0u; i < len; i++) {
+      rx[i] = (uint8_t)i;
+    }
+
+    OSBufferChain frame(Segments);
+    RadioHeader hdr = {(uint8_t)(rnd & 0x0F), -60};
+    if (!frame.append(rx, len) || !frame.prepend(&hdr, sizeof(hdr))) {
+      droppedCount++;
+      continue;
+    }
+
+    forward(toRouter, frame);
+  }
+}
+
+void vRouterTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    os_buf_segment_t* head;
+    toRouter.receive(head);
+
+    OSBufferChain frame(Segments, head);
+
+    RadioHeader radio;
+    frame.copyOut(0, &radio, sizeof(radio));
+    frame.strip(sizeof(radio));
+
+    // Goes right into the freed headroom, payload stays where it is
+    RouteHeader route = {radio.channel, (uint16_t)frame.getLength()};
+    if (!frame.prepend(&route, sizeof(route))) {
+      droppedCount++;
+      continue;
+    }
+
+    forward(toApp, frame);
+  }
+}
+
+void vAppTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t framesCount = 0u;
+  uint32_t bytesCount = 0u;
+  uint32_t lastPrint = millis();
+
+  for (;;) {
+    os_buf_segment_t* head;
+    if (toApp.receive(head, 100)) {
+      OSBufferChain frame(Segments, head);
+
+      RouteHeader route;
+      frame.copyOut(0, &route, sizeof(route));
+      frame.strip(sizeof(route));
+
+      uint32_t sum = 0u;
+      frame.forEachSpan([&sum](const uint8_t* data, uint32_t size) {
+        for (uint32_t i = 0u; i < size; i++) {
+          sum += data[i];
+        }
+      });
+      (void)sum;
+
+      framesCount++;
+      bytesCount += route.length;
+      // Segments go back to the pool here
+    }
+
+    if ((millis() - lastPrint) >= 1000u) {
+      lastPrint = millis();
+      Serial.printf("chain,%u,%u,%u,%u\n", (unsigned)framesCount, (unsigned)bytesCount,
+                    (unsigned)droppedCount, (unsigned)Segments.getFreeCount());
+    }
+  }
+}
@@ -0,0 +1,150 @@
+#include "FreeRTOS_helper.hpp"
+
+// Read-mostly routing table without a lock on lookups:
+// several Forwarder Tasks look up a route for every "packet",
+// while Control Task rarely adds and removes routes.
+// The same lookups through OSMutex are measured as a reference.
+//
+// Status is printed as CSV lines every second:
+//   map,<impl>,<readers>,<lookups>,<hits>,<ns_per_lookup>
+// where "impl" is "lock_free" or "mutex".
+
+#define FORWARDERS 3u
+#define ROUTES 48u
+#define LOOKUPS_PER_ROUND 20000u
+
+typedef struct {
+  uint32_t nextHop;
+  uint16_t port;
+  uint16_t metric;
+} Route;
+
+OSConcurrentMap<uint32_t, Route, 64> Routes;
+
+// Reference: same table behind a Mutex
+OSMutex tableMutex;
+
+volatile bool useMutex = false;
+OSAtomic<uint32_t> hitsCount;
+
+// Declaration of Task code
+void vForwarderTask(void* pvArg);
+void vControlTask(void* pvArg);
+void vReportTask(void* pvArg);
+
+OSTask <2048> Forwarders[FORWARDERS] = {
+  {vForwarderTask, "Fwd0", nullptr, tskIDLE_PRIORITY + 1},
+  {vForwarderTask, "Fwd1", nullptr, tskIDLE_PRIORITY + 1},
+  {vForwarderTask, "Fwd2", nullptr, tskIDLE_PRIORITY + 1},
+};
+OSTask <2048> ControlTask(vControlTask, "Control", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <2048> ReportTask(vReportTask, "Report", nullptr, tskIDLE_PRIORITY + 3);
+
+Counter <FORWARDERS> ForwardersDone;
+
+bool lookup(uint32_t addr, Route& route)
+{
+  if (!useMutex) {
+    return Routes.find(addr, route);
+  }
+
+  tableMutex.lock();
+  bool found = Routes.find(addr, route);
+  tableMutex.unlock();
+  return found;
+}
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  Routes.init();
+  tableMutex.init();
+  ForwardersDone.init();
+
+  for (uint32_t addr = 0u; addr < ROUTES; addr++) {
+    Routes.insert(addr, Route{addr + 1000u, (uint16_t)(addr % 4u), 1u});
+  }
+
+  for (uint32_t i = 0u; i < FORWARDERS; i++) {
+    Forwarders[i].setArg(reinterpret_cast<void*>(&Forwarders[i]));
+    Forwarders[i].init();
+  }
+  ControlTask.init();
+  ReportTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vForwarderTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+  uint32_t addr = reinterpret_cast<uintptr_t>(self) & 0xFFu;
+
+  for (;;) {
+    self->waitSignal();
+
+    uint32_t hits = 0u;
+    for (uint32_t i = 0u; i < LOOKUPS_PER_ROUND; i++) {
+      Route route;
+      addr = (addr * 1103515245u + 12345u);
+      if (lookup((addr >> 16) % (ROUTES + 8u), route)) {
+        hits++;
+      }
+    }
+    hitsCount.fetchAdd(hits);
+
+    ForwardersDone.give();
+  }
+}
+
+void vControlTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t addr = 0u;
+
+  for (;;) {
+    OSTask<0>::delay(10);
+
+    // Route flaps once in a while, lookups never wait for it
+    addr = (addr + 7u) % ROUTES;
+    Routes.remove(addr);
+    Routes.insert(addr, Route{addr + 2000u, (uint16_t)(addr % 4u), 2u});
+  }
+}
+
+void runRound(bool withMutex)
+{
+  useMutex = withMutex;
+  hitsCount.store(0u);
+
+  uint32_t start = OSTimestamp::now();
+  for (uint32_t i = 0u; i < FORWARDERS; i++) {
+    Forwarders[i].emitSignal();
+  }
+  for (uint32_t i = 0u; i < FORWARDERS; i++) {
+    ForwardersDone.take();
+  }
+  uint32_t elapsed = OSTimestamp::now() - start;
+
+  const uint32_t lookups = FORWARDERS * LOOKUPS_PER_ROUND;
+  Serial.printf("map,%s,%u,%u,%u,%u\n", withMutex ? "mutex" : "lock_free",
+                (unsigned)FORWARDERS, (unsigned)lookups, (unsigned)hitsCount.load(),
+                (unsigned)(OSTimestamp::toNs(elapsed) / lookups));
+}
+
+void vReportTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    runRound(false);
+    runRound(true);
+    OSTask<0>::delay(1000);
+  }
+}
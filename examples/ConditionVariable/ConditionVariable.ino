@@ -0,0 +1,90 @@
+#include "FreeRTOS_helper.hpp"
+
+// Waiting for a state protected by Mutex, without polling:
+// Writer waits till Sampler fills a batch, Sampler waits till
+// Writer has taken the previous one. Both wake up at once on change.
+//
+// Status is printed as CSV lines every batch:
+//   condvar,<batch>,<wait_ns>
+
+#define BATCH_SIZE 32u
+
+// Declaration of Task code
+void vSamplerTask(void* pvArg);
+void vWriterTask(void* pvArg);
+
+OSTask <2048> SamplerTask(vSamplerTask, "Sampler", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <4096> WriterTask(vWriterTask, "Writer", nullptr, tskIDLE_PRIORITY + 1);
+
+OSMutex batchMutex;
+OSConditionVariable batchChanged;
+
+// State protected by batchMutex
+uint32_t batch[BATCH_SIZE];
+uint32_t batchFill = 0u;
+uint32_t batchesCount = 0u;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  batchMutex.init();
+
+  SamplerTask.init();
+  WriterTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vSamplerTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    OSTask<0>::delay(5);
+
+    batchMutex.lock();
+    // Previous batch must be taken by Writer first
+    batchChanged.wait(batchMutex, [] { return batchFill < BATCH_SIZE; });
+
+    batch[batchFill++] = (uint32_t)micros();
+    bool full = (batchFill == BATCH_SIZE);
+    batchMutex.unlock();
+
+    if (full) {
+      batchChanged.notifyAll();
+    }
+  }
+}
+
+void vWriterTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t copy[BATCH_SIZE];
+
+  for (;;) {
+    uint32_t start = OSTimestamp::now();
+
+    batchMutex.lock();
+    if (!batchChanged.wait(batchMutex, [] { return batchFill == BATCH_SIZE; }, 1000)) {
+      batchMutex.unlock();
+      Serial.printf("condvar,timeout\n");
+      continue;
+    }
+
+    uint32_t time = OSTimestamp::now() - start;
+    memcpy(copy, batch, sizeof(copy));
+    batchFill = 0u;
+    batchesCount++;
+    batchMutex.unlock();
+
+    batchChanged.notifyAll();
+
+    Serial.printf("condvar,%u,%u\n", (unsigned)batchesCount, (unsigned)OSTimestamp::toNs(time));
+  }
+}
@@ -0,0 +1,89 @@
+#include "FreeRTOS_helper.hpp"
+
+// Temporal isolation with CPU budgets.
+// "Greedy" Task runs at high priority and would starve "Victim" forever,
+// but its group may spend only 3ms of CPU per every 10ms,
+// after that it's demoted below "Victim" till the next period.
+//
+// Requires configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY.
+// Status is printed as CSV line every second:
+//   budget,<victim_loops>,<greedy_consumed_us>,<throttle_count>
+
+// Declaration of Task code
+void vSupervisorTask(void* pvArg);
+void vGreedyTask(void* pvArg);
+void vVictimTask(void* pvArg);
+void vReportTask(void* pvArg);
+
+// Everything is on one core, so Greedy can really starve Victim.
+// Supervisor must share the core with the Tasks it watches anyway:
+// run time of a Task running on another core is accounted only when it's switched out.
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <2048> SupervisorTask(vSupervisorTask, "Budget", nullptr, configMAX_PRIORITIES - 1, OS_MCU_CORE_1);
+OSTask <1024> GreedyTask(vGreedyTask, "Greedy", nullptr, tskIDLE_PRIORITY + 3, OS_MCU_CORE_1);
+OSTask <1024> VictimTask(vVictimTask, "Victim", nullptr, tskIDLE_PRIORITY + 2, OS_MCU_CORE_1);
+#else
+OSTask <2048> SupervisorTask(vSupervisorTask, "Budget", nullptr, configMAX_PRIORITIES - 1);
+OSTask <1024> GreedyTask(vGreedyTask, "Greedy", nullptr, tskIDLE_PRIORITY + 3);
+OSTask <1024> VictimTask(vVictimTask, "Victim", nullptr, tskIDLE_PRIORITY + 2);
+#endif
+OSTask <2048> ReportTask(vReportTask, "Report", nullptr, configMAX_PRIORITIES - 2);
+
+// 3ms per 10ms, then drop to priority 1 (below Victim)
+OSBudgetGroup GreedyGroup(3000u, 10u, OS_BUDGET_DEMOTE, tskIDLE_PRIORITY + 1);
+OSBudgetSupervisor Supervisor;
+
+volatile uint32_t victimLoops = 0u;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  GreedyTask.init();
+  VictimTask.init();
+
+  GreedyGroup.addTask(GreedyTask);
+  Supervisor.addGroup(GreedyGroup);
+
+  SupervisorTask.init();
+  ReportTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vSupervisorTask([[maybe_unused]] void* pvArg)
+{
+  Supervisor.runForever(1u);
+}
+
+void vGreedyTask([[maybe_unused]] void* pvArg)
+{
+  volatile uint32_t counter = 0u;
+
+  for (;;) {
+    counter++;
+  }
+}
+
+void vVictimTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    victimLoops++;
+  }
+}
+
+void vReportTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    OSTask<0>::delay(1000);
+
+    Serial.printf("budget,%u,%u,%u\n", (unsigned)victimLoops,
+                  (unsigned)GreedyGroup.getConsumedUs(), (unsigned)GreedyGroup.getThrottleCount());
+  }
+}
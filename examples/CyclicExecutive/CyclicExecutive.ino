@@ -0,0 +1,108 @@
+#include "FreeRTOS_helper.hpp"
+
+// Time-triggered cyclic executive:
+// 4 minor frames of 5ms each, 20ms major cycle.
+// All steps run in a single Task in fixed order, so they share data
+// without any Mutex or Queue.
+//
+// Status is printed as CSV lines every second:
+//   cyclic,<major_cycles>,<overruns>,<skipped_frames>,<frame_wcet_ns>
+//   cyclic_slot,<slot>,<wcet_ns>
+
+void readSensors();
+void controlLoop();
+void updateFilter();
+void sendTelemetry();
+
+// Steps of every frame are executed in table order
+constexpr os_cyclic_slot_t kSchedule[] = {
+  {readSensors,   OS_CYCLIC_EVERY_FRAME},
+  {controlLoop,   OS_CYCLIC_EVERY_FRAME},
+  {updateFilter,  OS_CYCLIC_FRAME(0) | OS_CYCLIC_FRAME(2)},
+  {sendTelemetry, OS_CYCLIC_FRAME(3)},
+};
+
+typedef OSCyclicExecutive<5u, 4u> Executive;
+static_assert(Executive::isValid(kSchedule), "Schedule table is broken!");
+
+// Declaration of Task code
+void vExecutiveTask(void* pvArg);
+void vReportTask(void* pvArg);
+
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <4096> ExecutiveTask(vExecutiveTask, "Cyclic", nullptr, configMAX_PRIORITIES - 1, OS_MCU_CORE_1);
+#else
+OSTask <4096> ExecutiveTask(vExecutiveTask, "Cyclic", nullptr, configMAX_PRIORITIES - 1);
+#endif
+OSTask <2048> ReportTask(vReportTask, "Report", nullptr, tskIDLE_PRIORITY + 1);
+
+Executive Cyclic(ExecutiveTask, kSchedule);
+
+// Shared between steps, no locking needed
+int32_t sensorValue = 0;
+int32_t filteredValue = 0;
+int32_t actuatorValue = 0;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  ExecutiveTask.init();
+  ReportTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void readSensors()
+{
+  sensorValue = (int32_t)(micros() & 0x3FFu);
+}
+
+void controlLoop()
+{
+  actuatorValue = (filteredValue - sensorValue) / 2;
+}
+
+void updateFilter()
+{
+  filteredValue += (sensorValue - filteredValue) / 8;
+}
+
+void sendTelemetry()
+{
+  // Put it into a Queue here, printing takes too long for a 5ms frame
+}
+
+void onOverrun(uint32_t frame)
+{
+  (void)frame; // e.g. switch to safe state after several overruns
+}
+
+void vExecutiveTask([[maybe_unused]] void* pvArg)
+{
+  Cyclic.setOverrunCallback(onOverrun);
+  Cyclic.runForever();
+}
+
+void vReportTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    OSTask<0>::delay(1000);
+
+    Serial.printf("cyclic,%u,%u,%u,%llu\n", (unsigned)Cyclic.getMajorCycles(),
+                  (unsigned)Cyclic.getOverrunCount(), (unsigned)Cyclic.getSkippedCount(),
+                  (unsigned long long)Cyclic.getFrameWcetNs());
+
+    for (uint32_t i = 0u; i < Cyclic.getSlotsCount(); i++) {
+      Serial.printf("cyclic_slot,%u,%llu\n", (unsigned)i, (unsigned long long)Cyclic.getSlotWcetNs(i));
+    }
+  }
+}
@@ -0,0 +1,95 @@
+#include "FreeRTOS_helper.hpp"
+
+// Run-to-completion event Tasks sharing a single stack:
+// Sampler (priority 3) gets ticks from the Timer and feeds Filter (priority 2),
+// Filter sends results to Reporter (priority 1).
+// Posting to a higher priority Task is just a nested function call,
+// three "Tasks" cost one OSTask stack.
+//
+// Status is printed as CSV lines every second:
+//   events,<samples>,<average>,<host_stack_free_words>
+
+typedef struct {
+  uint32_t uxValue;
+} Sample;
+
+// Declaration of handlers
+void onSample(const Sample& ev);
+void onFilter(const Sample& ev);
+void onReport(const Sample& ev);
+
+// Declaration of Task code
+void vKernelTask(void* pvArg);
+
+OSTask <4096> KernelTask(vKernelTask, "Events", nullptr, tskIDLE_PRIORITY + 2);
+OSEventKernel Kernel(KernelTask);
+
+OSEventTask<Sample, 8> SamplerTask(Kernel, 3u, onSample);
+OSEventTask<Sample, 8> FilterTask(Kernel, 2u, onFilter);
+OSEventTask<Sample, 4> ReporterTask(Kernel, 1u, onReport);
+
+// Events can be posted from Timer, other Tasks or ISR,
+// they are dispatched when current handler returns
+void tickCallback(TimerHandle_t xTimer);
+OSTimer TickTimer(tickCallback, "Tick", true);
+
+uint32_t samplesCount = 0u;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  // Every event Task needs a unique priority
+  assert(SamplerTask.isValid() && FilterTask.isValid() && ReporterTask.isValid());
+
+  KernelTask.init();
+  TickTimer.init();
+  TickTimer.start(1);
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void tickCallback([[maybe_unused]] TimerHandle_t xTimer)
+{
+  Sample ev = {(uint32_t)(micros() & 0xFFu)};
+  SamplerTask.post(ev);
+}
+
+void onSample(const Sample& ev)
+{
+  samplesCount++;
+  FilterTask.post(ev);
+}
+
+void onFilter(const Sample& ev)
+{
+  static uint32_t sum = 0u;
+  static uint32_t count = 0u;
+
+  sum += ev.uxValue;
+  if (++count == 1000u) {
+    Sample avg = {sum / count};
+    ReporterTask.post(avg);
+    sum = 0u;
+    count = 0u;
+  }
+}
+
+void onReport(const Sample& ev)
+{
+  // The only slow handler. Ticks posted by the Timer meanwhile are queued,
+  // they don't preempt it and run right after it returns.
+  Serial.printf("events,%u,%u,%u\n", (unsigned)samplesCount, (unsigned)ev.uxValue,
+                (unsigned)uxTaskGetStackHighWaterMark(nullptr));
+}
+
+void vKernelTask([[maybe_unused]] void* pvArg)
+{
+  Kernel.runForever();
+}
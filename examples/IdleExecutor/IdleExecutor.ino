@@ -0,0 +1,86 @@
+#include "FreeRTOS_helper.hpp"
+
+// Background jobs executed in spare CPU time.
+// Instead of separate low priority Tasks (with their own stacks),
+// jobs are queued into OSIdleExecutor and executed in small time slices
+// by a single worker Task with the lowest priority.
+// With configUSE_IDLE_HOOK call Background.runFromIdle()
+// from vApplicationIdleHook() instead, then no worker Task is needed at all.
+
+OSIdleExecutor<8> Background;
+
+// Declaration of Task code
+void vWorkerTask(void* pvArg);
+void vAppMainTask(void* pvArg);
+
+OSTask <2048> WorkerTask(vWorkerTask, "Background", nullptr, tskIDLE_PRIORITY);
+OSTask <2048> AppMainTask(vAppMainTask, "AppMainTask", nullptr, tskIDLE_PRIORITY + 2);
+
+// Long job split in slices: sums a big range step by step
+struct SumJob {
+  uint32_t next;
+  uint32_t last;
+  uint64_t sum;
+};
+
+SumJob sumJob = {0u, 2000000u, 0u};
+
+bool sumStep(void* pvArg, uint32_t uxDeadline)
+{
+  auto job = reinterpret_cast<SumJob*>(pvArg);
+
+  // Check the clock only every 64 steps, it's not free
+  while (!OSIdleExecutorBase::isExpired(uxDeadline)) {
+    for (uint32_t i = 0u; (i < 64u) && (job->next < job->last); i++) {
+      job->sum += job->next++;
+    }
+    if (job->next == job->last) {
+      Serial.printf("job,sum,done,%llu\n", (unsigned long long)job->sum);
+      return false;
+    }
+  }
+
+  return true; // call me again
+}
+
+// Short job done in a single slice
+bool reportStats([[maybe_unused]] void* pvArg, [[maybe_unused]] uint32_t uxDeadline)
+{
+  Serial.printf("job,stats,%u,%u,%u\n", (unsigned)Background.getRunCount(),
+                (unsigned)Background.getOverrunCount(), (unsigned)Background.getDroppedCount());
+  return false;
+}
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  WorkerTask.init();
+  AppMainTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vWorkerTask([[maybe_unused]] void* pvArg)
+{
+  Background.runForever(WorkerTask);
+}
+
+void vAppMainTask([[maybe_unused]] void* pvArg)
+{
+  // 200us slices for the long job
+  Background.submit(sumStep, &sumJob, 200u);
+
+  for (;;) {
+    OSTask<0>::delay(1000);
+    Background.submit(reportStats);
+  }
+}
@@ -0,0 +1,105 @@
+// Emits kernel hooks of the monitor, only in one file of the project!
+#define OS_LATENCY_MONITOR_IMPL
+
+#include "FreeRTOS_helper.hpp"
+#include "helpers/rtos_helper_latency.hpp"
+
+// Ready-to-running latency of a periodic "control loop" Task,
+// disturbed by a higher priority Task which wakes up on the same tick
+// every 3ms and keeps CPU busy for a while. Control is readied by the tick,
+// but is dispatched only after it, so every 3rd sample shows ~DISTURB_BUSY_US.
+// Critical sections would not show up here: they mask the tick,
+// so readying itself is late too (see notes of OSLatencyMonitor).
+//
+// Requires this line at the end of FreeRTOSConfig.h:
+//   #include "helpers/rtos_helper_latency_trace.h"
+//
+// Statistics are printed as CSV lines every 5 seconds:
+//   sched_latency,<task>,<samples>,<avg_ns>,<max_ns>
+//   sched_latency_hist,<task>,<bucket_from_ns>,<samples>
+
+// Busy time of the disturbing Task
+#define DISTURB_BUSY_US 50u
+// Period of the disturbing Task in ms
+#define DISTURB_PERIOD_MS 3u
+
+// Declaration of Task code
+void vControlTask(void* pvArg);
+void vDisturbTask(void* pvArg);
+void vReportTask(void* pvArg);
+
+// Cycle counters of different cores are not synchronised, keep them together
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+OSTask <2048> ControlTask(vControlTask, "Control", nullptr, configMAX_PRIORITIES - 2, OS_MCU_CORE_1);
+OSTask <1024> DisturbTask(vDisturbTask, "Disturb", nullptr, configMAX_PRIORITIES - 1, OS_MCU_CORE_1);
+#else
+OSTask <2048> ControlTask(vControlTask, "Control", nullptr, configMAX_PRIORITIES - 2);
+OSTask <1024> DisturbTask(vDisturbTask, "Disturb", nullptr, configMAX_PRIORITIES - 1);
+#endif
+OSTask <3072> ReportTask(vReportTask, "Report", nullptr, tskIDLE_PRIORITY + 2);
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  ControlTask.init();
+  OSLatencyMonitor::attach(ControlTask);
+
+  DisturbTask.init();
+  ReportTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vControlTask([[maybe_unused]] void* pvArg)
+{
+  ControlTask.syncWaitInit();
+
+  for (;;) {
+    ControlTask.syncWait(1);
+  }
+}
+
+void vDisturbTask([[maybe_unused]] void* pvArg)
+{
+  DisturbTask.syncWaitInit();
+
+  for (;;) {
+    // Wakes up on the same tick as Control, but runs first
+    DisturbTask.syncWait(DISTURB_PERIOD_MS);
+    delayMicroseconds(DISTURB_BUSY_US);
+  }
+}
+
+void vReportTask([[maybe_unused]] void* pvArg)
+{
+  os_latency_stats_t stats;
+
+  for (;;) {
+    OSTask<0>::delay(5000);
+
+    if (!OSLatencyMonitor::getStats(ControlTask.getHandler(), stats) || (stats.uxSamples == 0u)) {
+      continue;
+    }
+    OSLatencyMonitor::reset(ControlTask.getHandler());
+
+    Serial.printf("sched_latency,%s,%u,%llu,%llu\n", ControlTask.getName(), (unsigned)stats.uxSamples,
+                  (unsigned long long)OSTimestamp::toNs((uint32_t)(stats.ullTotalTicks / stats.uxSamples)),
+                  (unsigned long long)OSTimestamp::toNs(stats.uxMaxTicks));
+
+    for (uint32_t i = 0u; i < OS_LATENCY_MONITOR_BUCKETS; i++) {
+      if (stats.uxHistogram[i] != 0u) {
+        Serial.printf("sched_latency_hist,%s,%llu,%u\n", ControlTask.getName(),
+                      (unsigned long long)OSLatencyMonitor::getBucketNs(i), (unsigned)stats.uxHistogram[i]);
+      }
+    }
+  }
+}
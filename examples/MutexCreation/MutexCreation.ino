@@ -58,7 +58,7 @@ void vAppMainTask([[maybe_unused]] void* pvArg)
 {
   assert(pvArg != nullptr);
 
-  auto AppTask = reinterpret_cast< OSTask<0>* >(pvArg);
+  auto AppTask = reinterpret_cast< OSTaskBase* >(pvArg);
 
   for (;;) {
     printMessage(AppTask->getName());
@@ -0,0 +1,116 @@
+#include "FreeRTOS_helper.hpp"
+
+// Priority donation through request/response channel:
+// high priority Control Task requests data from low priority Storage Task,
+// while middle priority Background Task keeps CPU busy
+// and lowest priority Bulk Task floods Storage with its own requests.
+// Storage runs with Control's priority while handling its request,
+// so Background load does not delay the reply. Requests are served
+// in priority order, so Control never waits behind queued Bulk requests.
+//
+// Round-trip latency is printed as CSV lines every second:
+//   rpc,<calls>,<max_ns>,<last_ns>
+
+typedef struct {
+  uint32_t uxAddress;
+} ReadCmd;
+
+typedef struct {
+  uint32_t uxValue;
+} ReadResult;
+
+// Declaration of Task code
+void vControlTask(void* pvArg);
+void vStorageTask(void* pvArg);
+void vBackgroundTask(void* pvArg);
+void vBulkTask(void* pvArg);
+
+OSTask <2048> ControlTask(vControlTask, "Control", nullptr, tskIDLE_PRIORITY + 3);
+OSTask <2048> BackgroundTask(vBackgroundTask, "Background", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <2048> StorageTask(vStorageTask, "Storage", nullptr, tskIDLE_PRIORITY + 1);
+OSTask <2048> BulkTask(vBulkTask, "Bulk", nullptr, tskIDLE_PRIORITY + 1);
+
+OSRpc<ReadCmd, ReadResult, 4> Storage(StorageTask);
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  StorageTask.init();
+  Storage.init();
+
+  ControlTask.init();
+  BackgroundTask.init();
+  BulkTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vControlTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t calls = 0u;
+  uint32_t maxTime = 0u;
+  uint32_t lastReport = OSTimestamp::now();
+
+  for (;;) {
+    ReadCmd cmd = {calls};
+    ReadResult res;
+
+    uint32_t start = OSTimestamp::now();
+    Storage.call(cmd, res);
+    uint32_t time = OSTimestamp::now() - start;
+
+    calls++;
+    if (time > maxTime) {
+      maxTime = time;
+    }
+
+    if ((start - lastReport) >= OSTimestamp::getFrequency()) {
+      lastReport = start;
+      Serial.printf("rpc,%u,%u,%u\n", (unsigned)calls,
+                    (unsigned)OSTimestamp::toNs(maxTime), (unsigned)OSTimestamp::toNs(time));
+    }
+
+    OSTask<0>::delay(10);
+  }
+}
+
+void vStorageTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    Storage.serve([](const ReadCmd& cmd, ReadResult& res) {
+      delayMicroseconds(200); // pretend to read flash
+      res.uxValue = cmd.uxAddress * 2u;
+    });
+  }
+}
+
+void vBackgroundTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    // Busy for 50ms out of every 60ms, without donation
+    // Storage would wait for it, together with Control
+    delayMicroseconds(50000);
+    OSTask<0>::delay(10);
+  }
+}
+
+void vBulkTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t address = 0u;
+
+  for (;;) {
+    // Back to back requests, Storage always has one of them pending
+    ReadCmd cmd = {address++};
+    ReadResult res;
+    Storage.call(cmd, res);
+  }
+}
@@ -0,0 +1,107 @@
+#include "FreeRTOS_helper.hpp"
+
+// Compile-time schedulability check:
+// periods, execution budgets and blocking of every Task are declared once,
+// priorities are derived from periods (rate-monotonic)
+// and the build fails if any Task can miss its deadline.
+//
+// Analysis is printed as CSV lines on start:
+//   rta,<task>,<priority>,<response_us>,<deadline_us>
+//   rta_utilization,<permille>
+
+// All times are in microseconds
+constexpr OSTaskSpec kTasks[] = {
+  // period, wcet, priority, blocking
+  {5000u,   500u},                             // Control
+  {20000u,  3000u, OS_TASK_PRIORITY_RM, 200u}, // Sensors, shares a Mutex with Logger
+  {100000u, 20000u},                           // Logger
+};
+
+static_assert(OSSchedAnalysis::isSchedulable(kTasks), "Some Task can miss its deadline!");
+static_assert(OSSchedAnalysis::prioritiesFit(kTasks), "Not enough priorities, check configMAX_PRIORITIES");
+
+enum {
+  TASK_CONTROL = 0,
+  TASK_SENSORS,
+  TASK_LOGGER,
+  TASKS_COUNT
+};
+
+static_assert(TASKS_COUNT == (sizeof(kTasks) / sizeof(kTasks[0])), "Task spec is missing");
+
+// Declaration of Task code
+void vControlTask(void* pvArg);
+void vSensorsTask(void* pvArg);
+void vLoggerTask(void* pvArg);
+
+OSTask <2048> ControlTask(vControlTask, "Control", nullptr, OSSchedAnalysis::priority(kTasks, TASK_CONTROL));
+OSTask <2048> SensorsTask(vSensorsTask, "Sensors", nullptr, OSSchedAnalysis::priority(kTasks, TASK_SENSORS));
+OSTask <4096> LoggerTask(vLoggerTask, "Logger", nullptr, OSSchedAnalysis::priority(kTasks, TASK_LOGGER));
+
+OSMutex BusMutex;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  const char* names[] = {"Control", "Sensors", "Logger"};
+  for (uint32_t i = 0u; i < TASKS_COUNT; i++) {
+    Serial.printf("rta,%s,%u,%u,%u\n", names[i],
+                  (unsigned)OSSchedAnalysis::priority(kTasks, i),
+                  (unsigned)OSSchedAnalysis::responseTime(kTasks, i),
+                  (unsigned)kTasks[i].uxDeadline);
+  }
+  Serial.printf("rta_utilization,%u\n", (unsigned)OSSchedAnalysis::utilizationPermille(kTasks));
+
+  BusMutex.init();
+
+  ControlTask.init();
+  SensorsTask.init();
+  LoggerTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vControlTask([[maybe_unused]] void* pvArg)
+{
+  ControlTask.syncWaitInit();
+
+  for (;;) {
+    delayMicroseconds(400); // stays within 500us budget
+    ControlTask.syncWait(kTasks[TASK_CONTROL].uxPeriod / 1000u);
+  }
+}
+
+void vSensorsTask([[maybe_unused]] void* pvArg)
+{
+  SensorsTask.syncWaitInit();
+
+  for (;;) {
+    BusMutex.lock();
+    delayMicroseconds(150); // bus transfer
+    BusMutex.unlock();
+
+    delayMicroseconds(2000);
+    SensorsTask.syncWait(kTasks[TASK_SENSORS].uxPeriod / 1000u);
+  }
+}
+
+void vLoggerTask([[maybe_unused]] void* pvArg)
+{
+  LoggerTask.syncWaitInit();
+
+  for (;;) {
+    BusMutex.lock();
+    delayMicroseconds(200); // longest time Sensors can be blocked
+    BusMutex.unlock();
+
+    delayMicroseconds(15000);
+    LoggerTask.syncWait(kTasks[TASK_LOGGER].uxPeriod / 1000u);
+  }
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+
+#if !defined(OS_HELPER_VANILLA_FREERTOS)
+#error "Host only example, see \"Host builds and interleaving tests\" in README.md"
+#endif
+
+// Must be included before any other helper
+#include "helpers/rtos_helper_sched_explorer.hpp"
+#include "FreeRTOS_helper.hpp"
+
+// Finds and replays an ordering bug with OSSchedExplorer.
+// Two equal priority depositors do read-modify-write of "balance"
+// with an OSQueue send (audit log) in between. Preemption at that send
+// loses an update, but only in some interleavings.
+// Explorer runs EXPLORE_SEEDS schedules, remembers the first failing seed,
+// then replays it and checks that exactly the same schedule was taken.
+//
+// Build kernel and sketch with -DOS_HOST_TIME_SLICING=0, otherwise
+// the host timer may switch Tasks and a replay may take another path.
+//
+// Results are printed as CSV lines:
+//   explore,<seeds>,<failed_seeds>,<schedules_per_s>
+//   replay,<seed>,<trace_hash>,<same_schedule>,<same_result>
+// Program exits with status 1 if a replay did not repeat.
+
+#define EXPLORE_SEEDS 2000u
+#define REPLAY_TIMES 3u
+#define WORKERS 2u
+#define DEPOSITS 4u
+
+// Big enough for every deposit, so send() never blocks
+OSQueue<WORKERS * DEPOSITS, uint32_t> AuditLog;
+volatile uint32_t balance = 0u;
+
+// Declaration of Task code
+void vWorkerTask(void* pvArg);
+void vExplorerTask(void* pvArg);
+
+// Workers have equal priority, so they switch only on explorer's yields
+OSTask <2048> Workers[WORKERS] = {
+  {vWorkerTask, "Worker0", nullptr, tskIDLE_PRIORITY + 2},
+  {vWorkerTask, "Worker1", nullptr, tskIDLE_PRIORITY + 2},
+};
+OSTask <4096> ExplorerTask(vExplorerTask, "Explorer", nullptr, tskIDLE_PRIORITY + 3);
+
+Counter <WORKERS> WorkersDone;
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  AuditLog.init();
+  WorkersDone.init();
+
+  for (uint32_t i = 0u; i < WORKERS; i++) {
+    Workers[i].setArg(reinterpret_cast<void*>(&Workers[i]));
+    Workers[i].init();
+  }
+  ExplorerTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vWorkerTask(void* pvArg)
+{
+  auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+
+  for (;;) {
+    self->waitSignal();
+
+    for (uint32_t i = 0u; i < DEPOSITS; i++) {
+      // The bug: no lock around read-modify-write
+      uint32_t value = balance;
+      AuditLog.send(value);
+      balance = value + 1u;
+    }
+
+    WorkersDone.give();
+  }
+}
+
+// One schedule, returns "true" if no update was lost
+bool runScenario()
+{
+  balance = 0u;
+
+  for (uint32_t i = 0u; i < WORKERS; i++) {
+    Workers[i].emitSignal();
+  }
+  for (uint32_t i = 0u; i < WORKERS; i++) {
+    WorkersDone.take();
+  }
+
+  uint32_t record = 0u;
+  while (AuditLog.receive(record, 0u)) {
+  }
+
+  return (balance == (WORKERS * DEPOSITS));
+}
+
+void vExplorerTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t failedSeeds = 0u;
+  uint32_t firstFailedSeed = 0u;
+  uint32_t firstFailedHash = 0u;
+
+  uint32_t start = millis();
+  for (uint32_t seed = 1u; seed <= EXPLORE_SEEDS; seed++) {
+    OSSchedExplorer::seed(seed);
+    if (!runScenario()) {
+      if (failedSeeds++ == 0u) {
+        firstFailedSeed = seed;
+        firstFailedHash = OSSchedExplorer::getTraceHash();
+      }
+    }
+  }
+  uint32_t elapsed = millis() - start;
+
+  Serial.printf("explore,%u,%u,%u\n", (unsigned)EXPLORE_SEEDS, (unsigned)failedSeeds,
+                (unsigned)((EXPLORE_SEEDS * 1000u) / ((elapsed != 0u) ? elapsed : 1u)));
+
+  bool repeated = true;
+  if (failedSeeds != 0u) {
+    for (uint32_t i = 0u; i < REPLAY_TIMES; i++) {
+      OSSchedExplorer::seed(firstFailedSeed);
+      bool sameResult = !runScenario();
+      bool sameSchedule = (OSSchedExplorer::getTraceHash() == firstFailedHash);
+
+      Serial.printf("replay,%u,%08x,%u,%u\n", (unsigned)firstFailedSeed,
+                    (unsigned)OSSchedExplorer::getTraceHash(), (unsigned)sameSchedule, (unsigned)sameResult);
+      repeated = repeated && sameSchedule && sameResult;
+    }
+  }
+
+  exit(repeated ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,121 @@
+#include "FreeRTOS_helper.hpp"
+
+// One payload for several consumers with no copies:
+// Camera fills a frame once and sends only a reference to Display and Logger.
+// Frame goes back to the pool when the slower of them drops it.
+//
+// Status is printed as CSV lines every second:
+//   sharedbuf,<frames>,<dropped>,<free_buffers>
+
+#define FRAME_SIZE 2048u
+
+OSSharedBufPool<FRAME_SIZE, 4> Frames;
+
+OSQueue<4, os_shared_buf_t*> toDisplay;
+OSQueue<4, os_shared_buf_t*> toLogger;
+
+// Declaration of Task code
+void vCameraTask(void* pvArg);
+void vDisplayTask(void* pvArg);
+void vLoggerTask(void* pvArg);
+
+OSTask <2048> CameraTask(vCameraTask, "Camera", nullptr, tskIDLE_PRIORITY + 3);
+OSTask <2048> DisplayTask(vDisplayTask, "Display", nullptr, tskIDLE_PRIORITY + 2);
+OSTask <2048> LoggerTask(vLoggerTask, "Logger", nullptr, tskIDLE_PRIORITY + 1);
+
+volatile uint32_t droppedCount = 0u;
+
+// Reference which could not be sent must be dropped by the sender
+void publish(OSQueue<4, os_shared_buf_t*>& queue, const OSSharedBuf& frame)
+{
+  os_shared_buf_t* ref = frame.share();
+  if (!queue.send(ref, 0)) {
+    OSSharedBuf lost(ref);
+    droppedCount++;
+  }
+}
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  toDisplay.init();
+  toLogger.init();
+
+  CameraTask.init();
+  DisplayTask.init();
+  LoggerTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vCameraTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t framesCount = 0u;
+  uint32_t lastPrint = millis();
+
+  for (;;) {
+    OSTask<0>::delay(33);
+
+    OSSharedBuf frame = Frames.alloc();
+    if (!frame.isValid()) {
+      droppedCount++;
+      continue;
+    }
+
+    // Written only while the reference is unique
+    uint8_t* pixels = frame.getWritable();
+    for (uint32_t i = 0u; i < FRAME_SIZE; i++) {
+      pixels[i] = (uint8_t)(framesCount + i);
+    }
+    frame.setLength(FRAME_SIZE);
+
+    publish(toDisplay, frame);
+    publish(toLogger, frame);
+    framesCount++;
+    // Own reference is dropped here
+
+    if ((millis() - lastPrint) >= 1000u) {
+      lastPrint = millis();
+      Serial.printf("sharedbuf,%u,%u,%u\n", (unsigned)framesCount, (unsigned)droppedCount,
+                    (unsigned)Frames.getFreeCount());
+    }
+  }
+}
+
+void vDisplayTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    os_shared_buf_t* ref;
+    toDisplay.receive(ref);
+
+    OSSharedBuf frame(ref);
+    // Pretend to push pixels to the screen
+    volatile uint8_t first = frame.getData()[0];
+    (void)first;
+    OSTask<0>::delay(5);
+  }
+}
+
+void vLoggerTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    os_shared_buf_t* ref;
+    toLogger.receive(ref);
+
+    OSSharedBuf frame(ref);
+    uint32_t sum = 0u;
+    for (uint32_t i = 0u; i < frame.getLength(); i++) {
+      sum += frame.getData()[i];
+    }
+    (void)sum;
+    // Slow storage
+    OSTask<0>::delay(50);
+  }
+}
@@ -0,0 +1,132 @@
+#include "FreeRTOS_helper.hpp"
+
+#if defined(ESP32)
+#include "esp_freertos_hooks.h"
+
+// Bounds of code in flash, from ESP-IDF linker script
+extern "C" int _text_start;
+extern "C" int _text_end;
+#endif
+
+// Always-on statistical profiler:
+// tick hook samples running Task every PROFILER_DIVIDER ticks,
+// reporting Task prints histogram as CSV lines every PROFILER_REPORT_MS:
+//   profile,task,<name>,<samples>,<percent>
+//   profile,pc,<bucket_address>,<samples>,<percent>
+//   profile,dropped,<samples>
+// PC lines are printed on ESP32 only, for buckets with at least 5% of samples,
+// map addresses to functions with addr2line.
+
+// Take sample every Nth tick
+#define PROFILER_DIVIDER 2u
+// Period of report
+#define PROFILER_REPORT_MS 5000u
+
+OSProfiler<256> Profiler;
+
+// Declaration of Task code
+void vReportTask(void* pvArg);
+void vBusyTask(void* pvArg);
+void vLazyTask(void* pvArg);
+
+OSTask <3072> ReportTask(vReportTask, "Report", nullptr, tskIDLE_PRIORITY + 3);
+OSTask <1024> BusyTask(vBusyTask, "Busy", nullptr, tskIDLE_PRIORITY + 1);
+OSTask <1024> LazyTask(vLazyTask, "Lazy", nullptr, tskIDLE_PRIORITY + 2);
+
+#if defined(ESP32)
+// Same signature as esp_freertos_tick_cb_t, only idle hooks return bool
+void IRAM_ATTR onTick(void)
+{
+  Profiler.tickHook();
+}
+#else
+// Requires configUSE_TICK_HOOK in FreeRTOSConfig.h
+extern "C" void vApplicationTickHook(void)
+{
+  Profiler.tickHook();
+}
+#endif
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  Profiler.setDivider(PROFILER_DIVIDER);
+#if defined(ESP32)
+  Profiler.setPcRange((uintptr_t)&_text_start, (uintptr_t)&_text_end);
+#endif
+  Profiler.start();
+
+#if defined(ESP32)
+  esp_register_freertos_tick_hook_for_cpu(onTick, 0);
+#endif
+
+  BusyTask.init();
+  LazyTask.init();
+  ReportTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vReportTask([[maybe_unused]] void* pvArg)
+{
+  for (;;) {
+    // Ring holds 256 samples, so drain it well before it's full
+    for (uint32_t t = 0u; t < PROFILER_REPORT_MS; t += 100u) {
+      OSTask<0>::delay(100);
+      Profiler.aggregate();
+    }
+
+    uint32_t total = Profiler.getSamplesTotal();
+    if (total == 0u) {
+      continue;
+    }
+
+    for (uint32_t i = 0u; i < Profiler.getTasksCount(); i++) {
+      uint32_t samples = Profiler.getTaskSamples(i);
+      Serial.printf("profile,task,%s,%u,%u\n", pcTaskGetName(Profiler.getTask(i)),
+                    (unsigned)samples, (unsigned)((samples * 100u) / total));
+    }
+#if defined(ESP32)
+    for (uint32_t i = 0u; i < Profiler.getPcBucketsCount(); i++) {
+      uint32_t samples = Profiler.getPcBucketSamples(i);
+      if ((samples * 100u) >= (total * 5u)) {
+        Serial.printf("profile,pc,0x%08x,%u,%u\n", (unsigned)Profiler.getPcBucketAddress(i),
+                      (unsigned)samples, (unsigned)((samples * 100u) / total));
+      }
+    }
+#endif
+    Serial.printf("profile,dropped,%u\n", (unsigned)Profiler.getDroppedCount());
+
+    Profiler.reset();
+  }
+}
+
+// Burns CPU all the time
+void vBusyTask([[maybe_unused]] void* pvArg)
+{
+  volatile uint32_t counter = 0u;
+
+  for (;;) {
+    counter++;
+  }
+}
+
+// Burns CPU for a while, then sleeps
+void vLazyTask([[maybe_unused]] void* pvArg)
+{
+  volatile uint32_t counter = 0u;
+
+  for (;;) {
+    for (uint32_t i = 0u; i < 100000u; i++) {
+      counter++;
+    }
+    OSTask<0>::delay(10);
+  }
+}
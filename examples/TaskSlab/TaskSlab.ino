@@ -0,0 +1,66 @@
+#include "FreeRTOS_helper.hpp"
+
+// Short-lived Tasks without heap:
+// every 200ms Dispatcher spawns a job with its own stack from a preallocated slab.
+// Jobs just return when done, their slots are reused by the next spawn.
+//
+// Status is printed as CSV lines:
+//   slab,<spawned>,<rejected>,<free_slots>,<spawn_ns>
+
+OSTaskSlab<3, 4096> Jobs;
+
+// Declaration of Task code
+void vDispatcherTask(void* pvArg);
+void vJob(void* pvArg);
+
+OSTask <2048> DispatcherTask(vDispatcherTask, "Dispatcher", nullptr, tskIDLE_PRIORITY + 2);
+
+// This is usual procedure
+void setup()
+{
+  Serial.begin(115200);
+
+  OSTimestamp::init();
+
+  DispatcherTask.init();
+}
+
+// Most of the time this routine will not be needed
+void loop()
+{
+  // so, just switch to another task
+  OSTask<0>::delay(1000);
+}
+
+void vJob(void* pvArg)
+{
+  uint32_t durationMs = (uint32_t)(uintptr_t)pvArg;
+
+  // Something which really needs its own stack and may block
+  OSTask<0>::delay(durationMs);
+}
+
+void vDispatcherTask([[maybe_unused]] void* pvArg)
+{
+  uint32_t spawned = 0u;
+  uint32_t rejected = 0u;
+
+  for (;;) {
+    uint32_t durationMs = 100u + (spawned % 5u) * 150u;
+
+    uint32_t start = OSTimestamp::now();
+    TaskHandle_t job = Jobs.spawn(vJob, (void*)(uintptr_t)durationMs, tskIDLE_PRIORITY + 1);
+    uint32_t time = OSTimestamp::now() - start;
+
+    if (job != nullptr) {
+      spawned++;
+    } else {
+      rejected++;
+    }
+
+    Serial.printf("slab,%u,%u,%u,%u\n", (unsigned)spawned, (unsigned)rejected,
+                  (unsigned)Jobs.getFreeCount(), (unsigned)OSTimestamp::toNs(time));
+
+    OSTask<0>::delay(200);
+  }
+}
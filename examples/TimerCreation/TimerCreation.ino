@@ -8,6 +8,14 @@ void vAppTimerFunc(void* pvArg);
 // It will call provided function every specified time on start.
 OSTimer AppTimer(vAppTimerFunc, "AppTimer", true);
 
+// Inactivity timeout in lazy mode: restart() only moves the deadline,
+// when OS Timer fires earlier it re-arms itself for the remaining time.
+void vIdleTimerFunc(TimerHandle_t xTimer);
+OSTimer IdleTimer(vIdleTimerFunc, "IdleTimer");
+
+volatile bool idleStopped = false;
+uint32_t idleRounds = 0u;
+
 // This is usual procedure
 void setup()
 {
@@ -15,15 +23,33 @@ void setup()
 
   AppTimer.init();
 
+  IdleTimer.setLazyRestart(true);
+  IdleTimer.init();
+
   // This is way to launch timer and call it's function every 500 milliseconds
   AppTimer.start(500);
 }
 
-// Most of the time this routine will not be needed
+// Here it drives the lazy Timer
 void loop()
 {
-  // so, just switch to another task
-  OSTask<0>::yield();
+  // Stop during a pending lazy re-arm: deadline is moved to 150 ms,
+  // OS Timer still fires at 100 ms and re-arms for the rest,
+  // right at that moment it is stopped. Callback must never come after stop().
+  idleStopped = false;
+  IdleTimer.start(100);
+  OSTask<0>::delay(50);
+  IdleTimer.restart();
+  OSTask<0>::delay(50);
+  IdleTimer.stop();
+  idleStopped = true;
+
+  // Longer than any re-arm left
+  OSTask<0>::delay(200);
+
+  if ((++idleRounds % 10u) == 0u) {
+    Serial.printf("IdleTimer: %u stop rounds done\n", (unsigned)idleRounds);
+  }
 }
 
 // This is Task's regular function similar to loop()
@@ -38,3 +64,10 @@ void vAppTimerFunc([[maybe_unused]] void* pvArg)
   Serial.print("Hello from: ");
   Serial.println(AppTimer.getName());
 }
+
+void vIdleTimerFunc([[maybe_unused]] TimerHandle_t xTimer)
+{
+  if (idleStopped) {
+    Serial.println("IdleTimer fired after stop()!");
+  }
+}
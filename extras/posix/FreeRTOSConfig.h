@@ -0,0 +1,101 @@
+/**
+ * @file FreeRTOSConfig.h
+ *
+ * Kernel configuration for host builds of examples on the FreeRTOS POSIX port.
+ * Close to Arduino-ESP32 defaults, so sketches behave the same way.
+ * See "Host builds and interleaving tests" in README.md
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Scheduler ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Interleaving tests (see OSSchedExplorer) need every switch to come
+// from a yield or a block, not from the host timer: build kernel and test
+// with -DOS_HOST_TIME_SLICING=0
+#ifndef OS_HOST_TIME_SLICING
+#define OS_HOST_TIME_SLICING                    1
+#endif
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_TIME_SLICING                  OS_HOST_TIME_SLICING
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configTICK_RATE_HZ                      1000
+#define configMAX_PRIORITIES                    25
+#define configMAX_TASK_NAME_LEN                 16
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+
+// Stack sizes are in words of StackType_t (8 bytes on 64-bit host).
+// Ports which can't use smaller stack than PTHREAD_STACK_MIN fall back to default pthread stack.
+#define configMINIMAL_STACK_SIZE                4096
+#define configSTACK_DEPTH_TYPE                  uint32_t
+
+// Hooks, defaults are weak in main.cpp, so sketch may override them
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     1
+#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configUSE_MALLOC_FAILED_HOOK            0
+
+/* -------------------------------------------------------------- */
+/* -------------------- Memory ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Helpers use static allocation, kernel heap is left for loop Task (heap_3.c)
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configTOTAL_HEAP_SIZE                   (64 * 1024)
+
+/* -------------------------------------------------------------- */
+/* -------------------- Features ------------------------ */
+/* -------------------------------------------------------------- */
+
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configUSE_TASK_NOTIFICATIONS            1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   3
+#define configUSE_TRACE_FACILITY                1
+#define configGENERATE_RUN_TIME_STATS           0
+#define configQUEUE_REGISTRY_SIZE               0
+
+#define configUSE_TIMERS                        1
+#define configTIMER_TASK_PRIORITY               (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH                20
+#define configTIMER_TASK_STACK_DEPTH            configMINIMAL_STACK_SIZE
+
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_xTaskResumeFromISR              1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_eTaskGetState                   1
+#define INCLUDE_xTaskAbortDelay                 1
+#define INCLUDE_xTaskGetHandle                  1
+#define INCLUDE_xTimerPendFunctionCall          1
+
+#define configASSERT(x) assert(x)
+
+// clang-format on
+
+#endif // FREERTOS_CONFIG_H
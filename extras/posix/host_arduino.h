@@ -0,0 +1,122 @@
+/**
+ * @file host_arduino.h
+ *
+ * Minimal subset of Arduino API used by examples,
+ * so they can be built on the FreeRTOS POSIX port.
+ * Force included into the sketch, see "Host builds and interleaving tests" in README.md
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// POSIX port has no ISR context, tick runs from a signal handler.
+// Only OSIsrSim fakes it, rtos_helper_isr_sim.hpp overrides this one.
+#ifndef OS_HELPER_IS_INSIDE_ISR
+#define OS_HELPER_IS_INSIDE_ISR() pdFALSE
+#endif // OS_HELPER_IS_INSIDE_ISR
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Serial port replacement, everything goes into stdout
+ */
+class HostSerial
+{
+public:
+    void begin(unsigned long baud)
+    {
+        (void)baud;
+    }
+
+    __attribute__((format(printf, 2, 3))) int printf(const char* fmt, ...)
+    {
+        va_list args;
+        va_start(args, fmt);
+        int res = vprintf(fmt, args);
+        va_end(args);
+        fflush(stdout);
+        return res;
+    }
+
+    void print(const char* str)
+    {
+        fputs(str, stdout);
+        fflush(stdout);
+    }
+
+    void println(const char* str = "")
+    {
+        puts(str);
+        fflush(stdout);
+    }
+};
+
+static HostSerial Serial;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+static inline uint64_t _hostMicros(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static inline unsigned long micros(void)
+{
+    return (unsigned long)(uint32_t)_hostMicros();
+}
+
+static inline unsigned long millis(void)
+{
+    return (unsigned long)(uint32_t)(_hostMicros() / 1000ULL);
+}
+
+static inline void delay(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+// Busy wait, same as on target: Task keeps the CPU
+static inline void delayMicroseconds(uint32_t us)
+{
+    uint64_t start = _hostMicros();
+    while ((_hostMicros() - start) < us) {
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _HOST_ARDUINO_H
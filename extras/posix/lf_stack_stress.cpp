@@ -0,0 +1,192 @@
+/**
+ * @file lf_stack_stress.cpp
+ *
+ * Multi-threaded stress test of OSLockFreeStack on the host.
+ * Unlike examples/BenchLockFreeStack on the POSIX port, where only one Task
+ * runs at a time, here every thread is a real OS thread, so push and pop
+ * really run in parallel on all host cores and race in CAS loops.
+ * Only kernel headers are needed, nothing of the kernel is linked:
+ *
+ *   g++ -std=c++17 -O2 -DOS_HELPER_VANILLA_FREERTOS -I . $INC \
+ *       extras/posix/lf_stack_stress.cpp -pthread -o lf_stress && ./lf_stress [threads] [iterations]
+ *
+ * Every thread takes a few nodes, marks them as owned, checks the marks
+ * and pushes them back. A node handed out twice at the same time,
+ * or lost or duplicated in the end, is an error. Exit status is 1 then.
+ *
+ * On hosts with few cores a thread is rarely switched out between the load
+ * of the head and the CAS. So an interval timer yields from its signal
+ * handler every STRESS_PREEMPT_US, at random instructions like a tick does.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+// POSIX port has no ISR context, same as host_arduino.h
+#define OS_HELPER_IS_INSIDE_ISR() pdFALSE
+
+#include "helpers/rtos_helper_lf_stack.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+#define STRESS_THREADS 8u
+#define STRESS_ITERATIONS 2000000u
+// Few nodes, so threads fight for the same head all the time
+#define STRESS_NODES 8u
+// Max nodes held by a thread at once, pushed back in random order
+#define STRESS_HELD 3u
+// Period of forced preemption, 0 to disable
+#define STRESS_PREEMPT_US 20u
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+typedef struct {
+    std::atomic<uint32_t> owner; // 0 - free, otherwise thread number + 1
+    uint32_t payload;
+} StressNode;
+
+static StressNode nodes[STRESS_NODES];
+static OSLockFreeStack<StressNode, STRESS_NODES> freeNodes(nodes);
+
+static std::atomic<uint32_t> errors(0u);
+static std::atomic<uint64_t> pops(0u);
+
+static void onPreempt(int sig)
+{
+    (void)sig;
+    sched_yield();
+}
+
+static void startPreemption(void)
+{
+    struct sigaction xAction = {};
+    xAction.sa_handler = onPreempt;
+    xAction.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &xAction, nullptr);
+
+    struct itimerval xTimer = {};
+    xTimer.it_interval.tv_usec = STRESS_PREEMPT_US;
+    xTimer.it_value.tv_usec = STRESS_PREEMPT_US;
+    setitimer(ITIMER_REAL, &xTimer, nullptr);
+}
+
+static void stopPreemption(void)
+{
+    struct itimerval xTimer = {};
+    setitimer(ITIMER_REAL, &xTimer, nullptr);
+}
+
+static void stressThread(uint32_t uxThread, uint32_t uxIterations)
+{
+    StressNode* pxHeld[STRESS_HELD];
+    uint64_t uxPops = 0u;
+    // xorshift32, order of the stack must get shuffled, otherwise ABA is rare
+    uint32_t uxRandom = 0x9E3779B9u * (uxThread + 1u);
+
+    for (uint32_t i = 0u; i < uxIterations; i++) {
+        uxRandom ^= uxRandom << 13;
+        uxRandom ^= uxRandom >> 17;
+        uxRandom ^= uxRandom << 5;
+
+        uint32_t uxWanted = 1u + (uxRandom % STRESS_HELD);
+        uint32_t uxCount = 0u;
+
+        for (; uxCount < uxWanted; uxCount++) {
+            StressNode* pxNode = freeNodes.pop();
+            if (pxNode == nullptr) {
+                break;
+            }
+
+            uint32_t uxFree = 0u;
+            if (!pxNode->owner.compare_exchange_strong(uxFree, uxThread + 1u)) {
+                errors.fetch_add(1u); // somebody else holds it too
+            }
+            pxNode->payload = (uxThread << 24) | (i & 0xFFFFFFu);
+            pxHeld[uxCount] = pxNode;
+        }
+        uxPops += uxCount;
+
+        for (uint32_t k = 0u; k < uxCount; k++) {
+            // Rotate by a random amount
+            StressNode* pxNode = pxHeld[(k + (uxRandom >> 8)) % uxCount];
+            if ((pxNode->payload != ((uxThread << 24) | (i & 0xFFFFFFu))) ||
+                (pxNode->owner.load() != (uxThread + 1u))) {
+                errors.fetch_add(1u);
+            }
+            pxNode->owner.store(0u);
+            freeNodes.push(pxNode);
+        }
+    }
+
+    pops.fetch_add(uxPops);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t uxThreads = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : STRESS_THREADS;
+    uint32_t uxIterations = (argc > 2) ? (uint32_t)strtoul(argv[2], nullptr, 0) : STRESS_ITERATIONS;
+
+    freeNodes.fill();
+
+    if (STRESS_PREEMPT_US != 0u) {
+        startPreemption();
+    }
+
+    std::vector<std::thread> xThreads;
+    for (uint32_t t = 0u; t < uxThreads; t++) {
+        xThreads.emplace_back(stressThread, t, uxIterations);
+    }
+    for (auto& xThread : xThreads) {
+        xThread.join();
+    }
+
+    if (STRESS_PREEMPT_US != 0u) {
+        stopPreemption();
+    }
+
+    // Every node must come back exactly once, broken links may form a cycle
+    bool bSeen[STRESS_NODES] = {false};
+    uint32_t uxLeft = 0u;
+    for (StressNode* pxNode = freeNodes.pop(); (pxNode != nullptr) && (uxLeft <= STRESS_NODES);
+         pxNode = freeNodes.pop()) {
+        uint32_t uxIndex = freeNodes.getIndex(pxNode);
+        if (bSeen[uxIndex]) {
+            errors.fetch_add(1u);
+        }
+        bSeen[uxIndex] = true;
+        uxLeft++;
+    }
+    if (uxLeft != STRESS_NODES) {
+        errors.fetch_add(1u);
+    }
+
+    printf("lfstack,threads,%u,iterations,%u,pops,%llu,nodes,%u,errors,%u,hw_threads,%u\n",
+           (unsigned)uxThreads, (unsigned)uxIterations, (unsigned long long)pops.load(),
+           (unsigned)uxLeft, (unsigned)errors.load(), (unsigned)std::thread::hardware_concurrency());
+
+    return (errors.load() == 0u) ? 0 : 1;
+}
+
+// clang-format on
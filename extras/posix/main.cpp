@@ -0,0 +1,108 @@
+/**
+ * @file main.cpp
+ *
+ * Entry point for host builds of examples on the FreeRTOS POSIX port.
+ * Runs setup() and loop() of the sketch from a Task,
+ * same as "loopTask" of Arduino-ESP32 does.
+ * See "Host builds and interleaving tests" in README.md
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+#ifndef OS_HOST_LOOP_STACK_SIZE
+#define OS_HOST_LOOP_STACK_SIZE configMINIMAL_STACK_SIZE
+#endif
+
+#ifndef OS_HOST_LOOP_PRIORITY
+#define OS_HOST_LOOP_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Provided by the sketch
+void setup(void);
+void loop(void);
+
+static void vHostLoopTask(void* pvArg)
+{
+    (void)pvArg;
+
+    setup();
+    for (;;) {
+        loop();
+    }
+}
+
+int main(void)
+{
+    BaseType_t xStatus = xTaskCreate(vHostLoopTask, "loopTask", OS_HOST_LOOP_STACK_SIZE,
+                                     nullptr, OS_HOST_LOOP_PRIORITY, nullptr);
+    if (xStatus != pdPASS) {
+        fprintf(stderr, "loopTask creation failed\n");
+        return 1;
+    }
+
+    vTaskStartScheduler();
+
+    // Only if there is not enough memory for Idle or Timer Task
+    fprintf(stderr, "scheduler failed to start\n");
+    return 1;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+extern "C" {
+
+// Sketch may define it's own, e.g. to call OSIsrSim::tickHook()
+__attribute__((weak)) void vApplicationTickHook(void)
+{
+}
+
+// Signatures match v10 and v11 as configSTACK_DEPTH_TYPE is uint32_t
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxTaskTCBBuffer,
+                                   StackType_t** ppxTaskStackBuffer,
+                                   uint32_t* puxTaskStackSize)
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxTaskStackBuffer = uxIdleTaskStack;
+    *puxTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTaskTCBBuffer,
+                                    StackType_t** ppxTaskStackBuffer,
+                                    uint32_t* puxTaskStackSize)
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTaskStackBuffer = uxTimerTaskStack;
+    *puxTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+} // extern "C"
+
+// clang-format on
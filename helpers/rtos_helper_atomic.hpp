@@ -0,0 +1,349 @@
+/**
+ * @file rtos_helper_atomic.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_ATOMIC_HPP
+#define _RTOS_HELPER_ATOMIC_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#include <type_traits>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Native atomics are used only when compiler can do them without libcalls
+// (Xtensa with S32C1I, RISC-V with "A" extension, Cortex-M3 and newer, host).
+// Everything else (Cortex-M0+ on RP2040, ESP32-S2, ESP32-C3 ...) goes through
+// critical section, which is multi-core safe on FreeRTOS SMP ports.
+// Define OS_ATOMIC_FORCE_CRITICAL to always use critical section.
+#if defined(OS_ATOMIC_FORCE_CRITICAL)
+#define OS_ATOMIC_IS_NATIVE(T) false
+#else
+#define OS_ATOMIC_IS_NATIVE(T) __atomic_always_lock_free(sizeof(T), 0)
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Critical section usable from both Task and ISR
+ *
+ * @code{cpp}
+ * OSCriticalSection xListLock;
+ * ...
+ * auto xStatus = xListLock.enter();
+ * // ... very short code, no blocking calls ...
+ * xListLock.exit(xStatus);
+ * @endcode
+ *
+ * @note 1. Keep it as short as possible, interrupts are masked inside!
+ * @note 2. On ESP32 every object has it's own spinlock,
+ *          on other ports it's the kernel critical section.
+ */
+class OSCriticalSection
+{
+private:
+#if (defined(ESP32) || defined(ESP_PLATFORM))
+    // Spinlock shared between cores
+    portMUX_TYPE m_xMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+public:
+    /**
+     * @brief Enter critical section
+     *
+     * @retval Status which must be passed to @ref exit()
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION UBaseType_t enter(void)
+    {
+#if (defined(ESP32) || defined(ESP_PLATFORM))
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+            taskENTER_CRITICAL(&m_xMux);
+        } else {
+            taskENTER_CRITICAL_ISR(&m_xMux);
+        }
+        return 0u;
+#else
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+            taskENTER_CRITICAL();
+            return 0u;
+        }
+        return (UBaseType_t)taskENTER_CRITICAL_FROM_ISR();
+#endif
+    }
+
+    /**
+     * @brief Leave critical section
+     *
+     * @param uxStatus Value returned by @ref enter()
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION void exit(UBaseType_t uxStatus)
+    {
+#if (defined(ESP32) || defined(ESP_PLATFORM))
+        (void)uxStatus;
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+            taskEXIT_CRITICAL(&m_xMux);
+        } else {
+            taskEXIT_CRITICAL_ISR(&m_xMux);
+        }
+#else
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+            taskEXIT_CRITICAL();
+        } else {
+            taskEXIT_CRITICAL_FROM_ISR(uxStatus);
+        }
+#endif
+    }
+};
+
+
+/**
+ * @brief Portable atomic variable for integral and pointer types
+ *
+ * Maps to native instructions where CPU has them,
+ * and to a critical section everywhere else (e.g. RP2040).
+ * All operations are sequentially consistent.
+ *
+ * @code{cpp}
+ * OSAtomic<uint32_t> rxBytes;
+ * ...
+ * // In ISR or any Task on any core
+ * rxBytes.fetchAdd(len);
+ * ...
+ * uint32_t expected = rxBytes.load();
+ * while (!rxBytes.compareExchange(expected, expected / 2u)) {
+ *     // "expected" is updated with current value
+ * }
+ * @endcode
+ *
+ * @note 1. This class is thread-safe and multi-core safe
+ * @note 2. This class is an ISR safe
+ */
+template <class T>
+class OSAtomic
+{
+    static_assert(std::is_integral<T>::value || std::is_pointer<T>::value,
+                  "OSAtomic supports only integral and pointer types");
+
+private:
+    volatile T m_xValue;
+
+    // Shared lock for every non native atomic
+    static OSCriticalSection& _lock()
+    {
+        static OSCriticalSection xLock;
+        return xLock;
+    }
+
+public:
+    OSAtomic(T xValue = T()) : m_xValue(xValue){};
+
+    OSAtomic(const OSAtomic&) = delete;
+    OSAtomic& operator=(const OSAtomic&) = delete;
+
+    /**
+     * @brief Check if native instructions are used for this type
+     */
+    static constexpr bool isNative(void)
+    {
+        return OS_ATOMIC_IS_NATIVE(T);
+    }
+
+    /**
+     * @brief Read current value
+     */
+    OS_HOT_INLINE T load(void) const
+    {
+        if (isNative()) {
+            return __atomic_load_n(&m_xValue, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xValue = m_xValue;
+        _lock().exit(xStatus);
+        return xValue;
+    }
+
+    /**
+     * @brief Write new value
+     */
+    OS_HOT_INLINE void store(T xValue)
+    {
+        if (isNative()) {
+            __atomic_store_n(&m_xValue, xValue, __ATOMIC_SEQ_CST);
+            return;
+        }
+
+        auto xStatus = _lock().enter();
+        m_xValue = xValue;
+        _lock().exit(xStatus);
+    }
+
+    /**
+     * @brief Write new value
+     *
+     * @retval Previous value
+     */
+    OS_HOT_INLINE T exchange(T xValue)
+    {
+        if (isNative()) {
+            return __atomic_exchange_n(&m_xValue, xValue, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xPrev = m_xValue;
+        m_xValue = xValue;
+        _lock().exit(xStatus);
+        return xPrev;
+    }
+
+    /**
+     * @brief Write new value only if current one is equal to expected
+     *
+     * @param xExpected Expected value, updated with current one on failure
+     * @param xDesired New value
+     *
+     * @return "true" if value was replaced, "false" if not
+     */
+    OS_HOT_INLINE bool compareExchange(T& xExpected, T xDesired)
+    {
+        if (isNative()) {
+            return __atomic_compare_exchange_n(&m_xValue, &xExpected, xDesired, false,
+                                               __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        }
+
+        bool res = false;
+        auto xStatus = _lock().enter();
+        if (m_xValue == xExpected) {
+            m_xValue = xDesired;
+            res = true;
+        } else {
+            xExpected = m_xValue;
+        }
+        _lock().exit(xStatus);
+        return res;
+    }
+
+    /**
+     * @brief Add to the value
+     *
+     * @retval Previous value
+     */
+    OS_HOT_INLINE T fetchAdd(T xArg)
+    {
+        static_assert(std::is_integral<T>::value, "fetchAdd() supports only integral types");
+        if (isNative()) {
+            return __atomic_fetch_add(&m_xValue, xArg, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xPrev = m_xValue;
+        m_xValue = xPrev + xArg;
+        _lock().exit(xStatus);
+        return xPrev;
+    }
+
+    /**
+     * @brief Subtract from the value
+     *
+     * @retval Previous value
+     */
+    OS_HOT_INLINE T fetchSub(T xArg)
+    {
+        static_assert(std::is_integral<T>::value, "fetchSub() supports only integral types");
+        if (isNative()) {
+            return __atomic_fetch_sub(&m_xValue, xArg, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xPrev = m_xValue;
+        m_xValue = xPrev - xArg;
+        _lock().exit(xStatus);
+        return xPrev;
+    }
+
+    /**
+     * @brief Set bits of the value
+     *
+     * @retval Previous value
+     */
+    OS_HOT_INLINE T fetchOr(T xArg)
+    {
+        static_assert(std::is_integral<T>::value, "fetchOr() supports only integral types");
+        if (isNative()) {
+            return __atomic_fetch_or(&m_xValue, xArg, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xPrev = m_xValue;
+        m_xValue = xPrev | xArg;
+        _lock().exit(xStatus);
+        return xPrev;
+    }
+
+    /**
+     * @brief Clear bits of the value which are not set in argument
+     *
+     * @retval Previous value
+     */
+    OS_HOT_INLINE T fetchAnd(T xArg)
+    {
+        static_assert(std::is_integral<T>::value, "fetchAnd() supports only integral types");
+        if (isNative()) {
+            return __atomic_fetch_and(&m_xValue, xArg, __ATOMIC_SEQ_CST);
+        }
+
+        auto xStatus = _lock().enter();
+        T xPrev = m_xValue;
+        m_xValue = xPrev & xArg;
+        _lock().exit(xStatus);
+        return xPrev;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_ATOMIC_HPP
@@ -0,0 +1,284 @@
+/**
+ * @file rtos_helper_bip.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_BIP_HPP
+#define _RTOS_HELPER_BIP_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_task.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Untyped part of @ref OSBipBuffer
+ *
+ * Data is always in one or two regions: [read, last) at the end
+ * and [0, write) at the start of the buffer. Writer never splits
+ * a reservation, it skips the tail and wraps instead.
+ *
+ * @note Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSBipBufferBase
+{
+private:
+    uint8_t* m_pucBuffer = nullptr;
+    uint32_t m_uxSize = 0u;
+
+    // Written only by producer
+    OSAtomic<uint32_t> m_uxWrite;
+    // End of data at the end of the buffer, valid once write has wrapped
+    OSAtomic<uint32_t> m_uxLast;
+    // Written only by consumer
+    OSAtomic<uint32_t> m_uxRead;
+
+    // Current reservation, producer's private state
+    uint32_t m_uxReserveStart = 0u;
+    uint32_t m_uxReserveSize = 0u;
+
+    // Task waiting for data, if any
+    OSTaskBase* volatile m_pxConsumer = nullptr;
+
+protected:
+    // Only @ref OSBipBuffer is allowed to create it, as it holds the storage
+    OSBipBufferBase(uint8_t* pucBuffer, uint32_t uxSize)
+                                : m_pucBuffer(pucBuffer), m_uxSize(uxSize) {};
+
+public:
+    /**
+     * @brief Get contiguous space for a record
+     *
+     * @param uxSize Amount of bytes to reserve
+     *
+     * @retval Pointer to write the record into, nullptr if there is no such space
+     *
+     * @note 1. Only for a single producer, this method is an ISR safe
+     * @note 2. New reservation replaces previous uncommitted one
+     */
+    OS_HOT_SECTION uint8_t* reserve(uint32_t uxSize)
+    {
+        uint32_t uxWrite = m_uxWrite.load();
+        uint32_t uxRead = m_uxRead.load();
+        uint32_t uxStart;
+
+        if (uxWrite >= uxRead) {
+            if ((m_uxSize - uxWrite) >= uxSize) {
+                uxStart = uxWrite;
+            } else if (uxRead > uxSize) {
+                // Wrap, write must not catch up with read, it would look empty
+                uxStart = 0u;
+            } else {
+                return nullptr;
+            }
+        } else {
+            if ((uxRead - uxWrite) > uxSize) {
+                uxStart = uxWrite;
+            } else {
+                return nullptr;
+            }
+        }
+
+        m_uxReserveStart = uxStart;
+        m_uxReserveSize = uxSize;
+        return &m_pucBuffer[uxStart];
+    }
+
+    /**
+     * @brief Publish reserved record to consumer
+     *
+     * @param uxSize Amount of bytes really written, not more than reserved
+     *
+     * @note Only for a single producer, this method is an ISR safe
+     */
+    OS_HOT_SECTION void commit(uint32_t uxSize)
+    {
+        assert(uxSize <= m_uxReserveSize);
+        if (uxSize > m_uxReserveSize) {
+            uxSize = m_uxReserveSize;
+        }
+        m_uxReserveSize = 0u;
+
+        if (uxSize == 0u) {
+            return;
+        }
+
+        uint32_t uxWrite = m_uxWrite.load();
+        if (m_uxReserveStart != uxWrite) {
+            // Wrapped: old data ends here, must be visible before new write index
+            m_uxLast.store(uxWrite);
+        }
+        m_uxWrite.store(m_uxReserveStart + uxSize);
+
+        OSTaskBase* pxConsumer = m_pxConsumer;
+        if (pxConsumer != nullptr) {
+            pxConsumer->emitSignal();
+        }
+    }
+
+    /**
+     * @brief Get contiguous committed data
+     *
+     * @param uxSize Amount of available bytes
+     *
+     * @retval Pointer to the data, nullptr if buffer is empty
+     *
+     * @note 1. Only for a single consumer, this method is an ISR safe
+     * @note 2. Data behind the wrap point is returned by the next read()
+     */
+    OS_HOT_SECTION uint8_t* read(uint32_t& uxSize)
+    {
+        uint32_t uxWrite = m_uxWrite.load();
+        uint32_t uxRead = m_uxRead.load();
+
+        if (uxWrite < uxRead) {
+            // Writer has wrapped, finish the end region first
+            if (uxRead == m_uxLast.load()) {
+                uxRead = 0u;
+                m_uxRead.store(0u);
+            } else {
+                uxSize = m_uxLast.load() - uxRead;
+                return &m_pucBuffer[uxRead];
+            }
+        }
+
+        uxSize = uxWrite - uxRead;
+        return (uxSize != 0u) ? &m_pucBuffer[uxRead] : nullptr;
+    }
+
+    /**
+     * @brief Free data returned by @ref read()
+     *
+     * @param uxSize Amount of consumed bytes, not more than returned by read()
+     *
+     * @note Only for a single consumer, this method is an ISR safe
+     */
+    OS_HOT_SECTION void release(uint32_t uxSize)
+    {
+        m_uxRead.store(m_uxRead.load() + uxSize);
+    }
+
+    /**
+     * @brief Wake up the Task on every commit
+     *
+     * @param pxConsumer Consumer Task using @ref OSTaskBase::waitSignal(),
+     *                   nullptr to disable
+     */
+    void setConsumer(OSTaskBase* pxConsumer)
+    {
+        m_pxConsumer = pxConsumer;
+    }
+
+    /**
+     * @brief Check if there is no committed data
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    bool isEmpty(void)
+    {
+        return (m_uxWrite.load() == m_uxRead.load());
+    }
+};
+
+
+/**
+ * @brief Lock-free single producer single consumer bip-buffer
+ *
+ * Producer reserves a contiguous span, writes a variable-length record
+ * right into it and commits. Consumer reads contiguous spans and releases them.
+ * Records are never split at the wrap point, so nothing is copied.
+ *
+ * @code{cpp}
+ * OSBipBuffer<1024> Frames;
+ * ...
+ * // Producer (Task or ISR)
+ * uint8_t* p = Frames.reserve(2u + payloadMax);
+ * if (p != nullptr) {
+ *     uint16_t len = encode(&p[2], payloadMax);
+ *     memcpy(p, &len, 2u);
+ *     Frames.commit(2u + len);
+ * }
+ * ...
+ * // Consumer
+ * uint32_t size;
+ * uint8_t* p = Frames.read(size);
+ * if (p != nullptr) {
+ *     uint16_t len;
+ *     memcpy(&len, p, 2u);
+ *     handle(&p[2], len);
+ *     Frames.release(2u + len);
+ * }
+ * @endcode
+ *
+ * @tparam Bytes Size of the buffer
+ *
+ * @note 1. Exactly one producer and one consumer, they may be on different cores.
+ * @note 2. Reservation can't be bigger than Bytes - 1,
+ *          and after a wrap only the space before read position is available.
+ */
+template <uint32_t Bytes>
+class OSBipBuffer : public OSBipBufferBase
+{
+    static_assert(Bytes > 1u, "Bytes must be more than 1");
+
+private:
+    uint8_t m_ucStorage[Bytes];
+
+public:
+    OSBipBuffer() : OSBipBufferBase(m_ucStorage, Bytes) {};
+
+    /**
+     * @brief Get size of the buffer
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return Bytes;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_BIP_HPP
@@ -0,0 +1,385 @@
+/**
+ * @file rtos_helper_budget.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_BUDGET_HPP
+#define _RTOS_HELPER_BUDGET_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_task.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Frequency of portGET_RUN_TIME_COUNTER_VALUE(), used to convert budgets.
+// ESP-IDF counts in microseconds, other ports often use 10x tick rate.
+#ifndef OS_BUDGET_RUN_TIME_HZ
+#define OS_BUDGET_RUN_TIME_HZ 1000000UL
+#endif // OS_BUDGET_RUN_TIME_HZ
+
+// Max amount of Tasks in a single group
+#ifndef OS_BUDGET_GROUP_MAX_TASKS
+#define OS_BUDGET_GROUP_MAX_TASKS 4u
+#endif // OS_BUDGET_GROUP_MAX_TASKS
+
+// Max amount of groups watched by a single supervisor
+#ifndef OS_BUDGET_MAX_GROUPS
+#define OS_BUDGET_MAX_GROUPS 4u
+#endif // OS_BUDGET_MAX_GROUPS
+
+// What to do with the group which has spent its budget
+typedef enum {
+  OS_BUDGET_DEMOTE = 0, // Drop priority until replenishment
+  OS_BUDGET_SUSPEND     // Suspend until replenishment
+} os_budget_action_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+#if ((configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1))
+/**
+ * @brief Tasks sharing a single CPU budget
+ *
+ * Group may spend up to "budget" of CPU time per every replenishment period,
+ * then it's demoted (or suspended) till the start of the next period.
+ * Single Task group gives a per-Task budget.
+ *
+ * @code{cpp}
+ * // 2ms of CPU every 10ms, then drop to priority 1
+ * OSBudgetGroup LoggingGroup(2000u, 10u, OS_BUDGET_DEMOTE, tskIDLE_PRIORITY + 1);
+ * ...
+ * LoggingGroup.addTask(LogTask);
+ * LoggingGroup.addTask(UploadTask);
+ * Supervisor.addGroup(LoggingGroup);
+ * @endcode
+ *
+ * @note 1. Requires configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY
+ * @note 2. Prefer OS_BUDGET_DEMOTE: suspended Task holding a Mutex
+ *          blocks everyone waiting for it till replenishment.
+ * @note 3. Pin the supervisor and all Tasks of its groups to the same core!
+ *          Kernel adds a slice to the run time counter only on switch out,
+ *          so Task busy on another core is not accounted till it yields,
+ *          which may never happen. On the same core every group Task
+ *          is switched out while the supervisor checks it.
+ */
+class OSBudgetGroup
+{
+private:
+    TaskHandle_t m_xTasks[OS_BUDGET_GROUP_MAX_TASKS];
+    // Priority to restore at replenishment
+    UBaseType_t m_uxPriorities[OS_BUDGET_GROUP_MAX_TASKS];
+    // Run time counter of every Task at the start of the period
+    uint32_t m_uxRunTimeStart[OS_BUDGET_GROUP_MAX_TASKS];
+    uint32_t m_uxTasksCount = 0u;
+
+    uint32_t m_uxBudget = 0u;        // In run time counter units
+    TickType_t m_xPeriod = 0u;
+    TickType_t m_xPeriodStart = 0u;
+    os_budget_action_t m_eAction = OS_BUDGET_DEMOTE;
+    UBaseType_t m_uxDemotePriority = tskIDLE_PRIORITY;
+
+    uint32_t m_uxConsumed = 0u;
+    uint32_t m_uxThrottleCount = 0u;
+    bool m_throttled = false;
+
+    static void _getInfo(TaskHandle_t xTask, TaskStatus_t& xStatus)
+    {
+        // eInvalid - state is not needed, pdFALSE - skip slow stack watermark scan
+        vTaskGetInfo(xTask, &xStatus, pdFALSE, eInvalid);
+    }
+
+    // Start new period, Tasks are not touched
+    void _snapshot(TickType_t xNow)
+    {
+        TaskStatus_t xStatus;
+        for (uint32_t i = 0u; i < m_uxTasksCount; i++) {
+            _getInfo(m_xTasks[i], xStatus);
+            m_uxRunTimeStart[i] = (uint32_t)xStatus.ulRunTimeCounter;
+        }
+        m_xPeriodStart = xNow;
+        m_uxConsumed = 0u;
+    }
+
+    void _throttle(void)
+    {
+        TaskStatus_t xStatus;
+
+        for (uint32_t i = 0u; i < m_uxTasksCount; i++) {
+            _getInfo(m_xTasks[i], xStatus);
+#if (configUSE_MUTEXES == 1)
+            // Don't store priority inherited through a Mutex
+            m_uxPriorities[i] = xStatus.uxBasePriority;
+#else
+            m_uxPriorities[i] = xStatus.uxCurrentPriority;
+#endif
+
+#if (INCLUDE_vTaskSuspend == 1)
+            if (m_eAction == OS_BUDGET_SUSPEND) {
+                vTaskSuspend(m_xTasks[i]);
+                continue;
+            }
+#endif // INCLUDE_vTaskSuspend
+            if (m_uxPriorities[i] > m_uxDemotePriority) {
+                vTaskPrioritySet(m_xTasks[i], m_uxDemotePriority);
+            }
+        }
+
+        m_throttled = true;
+        m_uxThrottleCount++;
+    }
+
+    void _restore(void)
+    {
+        for (uint32_t i = 0u; i < m_uxTasksCount; i++) {
+#if (INCLUDE_vTaskSuspend == 1)
+            if (m_eAction == OS_BUDGET_SUSPEND) {
+                vTaskResume(m_xTasks[i]);
+                continue;
+            }
+#endif // INCLUDE_vTaskSuspend
+            vTaskPrioritySet(m_xTasks[i], m_uxPriorities[i]);
+        }
+
+        m_throttled = false;
+    }
+
+public:
+    /**
+     * @brief Create group with CPU budget
+     *
+     * @param uxBudgetUs CPU time allowed per period in microseconds
+     * @param uxPeriodMs Replenishment period in milliseconds
+     * @param eAction What to do when budget is spent
+     * @param uxDemotePriority Priority used by OS_BUDGET_DEMOTE
+     */
+    OSBudgetGroup(uint32_t uxBudgetUs, uint32_t uxPeriodMs,
+                  os_budget_action_t eAction = OS_BUDGET_DEMOTE,
+                  UBaseType_t uxDemotePriority = tskIDLE_PRIORITY)
+                                : m_uxBudget((uint32_t)(((uint64_t)uxBudgetUs * OS_BUDGET_RUN_TIME_HZ) / 1000000ULL)),
+                                m_xPeriod(pdMS_TO_TICKS(uxPeriodMs)),
+                                m_eAction(eAction), m_uxDemotePriority(uxDemotePriority)
+    {
+        assert(m_xPeriod != 0u);
+    };
+
+    /**
+     * @brief Add Task to the group
+     *
+     * @param xTask Handler of already created Task
+     *
+     * @return "true" if successful, "false" if group is full
+     *
+     * @note Must be done before group is added to @ref OSBudgetSupervisor
+     */
+    bool addTask(TaskHandle_t xTask)
+    {
+        assert(xTask != nullptr);
+        assert(m_uxTasksCount < OS_BUDGET_GROUP_MAX_TASKS);
+        if ((xTask == nullptr) || (m_uxTasksCount >= OS_BUDGET_GROUP_MAX_TASKS)) {
+            return false;
+        }
+
+        m_xTasks[m_uxTasksCount++] = xTask;
+        return true;
+    }
+
+    /**
+     * @brief Add Task to the group
+     *
+     * @param xTask Task after @ref OSTaskBase::init()
+     *
+     * @return "true" if successful, "false" if group is full
+     */
+    bool addTask(OSTaskBase& xTask)
+    {
+        return addTask(xTask.getHandler());
+    }
+
+    /**
+     * @brief Account CPU time and apply or lift the throttling
+     *
+     * @param xNow Current tick count
+     *
+     * @note Called by @ref OSBudgetSupervisor
+     */
+    void update(TickType_t xNow)
+    {
+        if ((TickType_t)(xNow - m_xPeriodStart) >= m_xPeriod) {
+            if (m_throttled) {
+                _restore();
+            }
+            _snapshot(xNow);
+            return;
+        }
+
+        if (m_throttled) {
+            return;
+        }
+
+        TaskStatus_t xStatus;
+        uint32_t uxConsumed = 0u;
+        for (uint32_t i = 0u; i < m_uxTasksCount; i++) {
+            _getInfo(m_xTasks[i], xStatus);
+            uxConsumed += (uint32_t)xStatus.ulRunTimeCounter - m_uxRunTimeStart[i];
+        }
+        m_uxConsumed = uxConsumed;
+
+        if (uxConsumed >= m_uxBudget) {
+            _throttle();
+        }
+    }
+
+    /**
+     * @brief Start the first period
+     *
+     * @note Called by @ref OSBudgetSupervisor
+     */
+    void start(TickType_t xNow)
+    {
+        _snapshot(xNow);
+    }
+
+    /**
+     * @brief Check if group is throttled right now
+     */
+    bool isThrottled(void)
+    {
+        return m_throttled;
+    }
+
+    /**
+     * @brief Get CPU time consumed in current period at the last check
+     *
+     * @retval Time in microseconds
+     */
+    uint32_t getConsumedUs(void)
+    {
+        return (uint32_t)(((uint64_t)m_uxConsumed * 1000000ULL) / OS_BUDGET_RUN_TIME_HZ);
+    }
+
+    /**
+     * @brief Get amount of periods when budget was exceeded
+     */
+    uint32_t getThrottleCount(void)
+    {
+        return m_uxThrottleCount;
+    }
+};
+
+
+/**
+ * @brief Supervisor enforcing CPU budgets of @ref OSBudgetGroup
+ *
+ * Should be executed by the highest priority Task, so it's never starved
+ * by groups it watches. Precision of enforcement is the check period.
+ * On multi-core MCU pin it to the core of the watched Tasks,
+ * see notes of @ref OSBudgetGroup.
+ *
+ * @code{cpp}
+ * OSBudgetSupervisor Supervisor;
+ * OSTask <2048> SupervisorTask(vSupervisorTask, "Budget", nullptr, configMAX_PRIORITIES - 1);
+ * ...
+ * void vSupervisorTask(void* pvArg)
+ * {
+ *     Supervisor.runForever(1u); // check every 1ms
+ * }
+ * @endcode
+ */
+class OSBudgetSupervisor
+{
+private:
+    OSBudgetGroup* m_pxGroups[OS_BUDGET_MAX_GROUPS];
+    uint32_t m_uxGroupsCount = 0u;
+
+public:
+    OSBudgetSupervisor() {};
+
+    /**
+     * @brief Start watching the group
+     *
+     * @param xGroup Group with all Tasks already added
+     *
+     * @return "true" if successful, "false" if there is no free slot
+     *
+     * @note This method is NOT thread-safe, add groups before @ref runForever()
+     */
+    bool addGroup(OSBudgetGroup& xGroup)
+    {
+        assert(m_uxGroupsCount < OS_BUDGET_MAX_GROUPS);
+        if (m_uxGroupsCount >= OS_BUDGET_MAX_GROUPS) {
+            return false;
+        }
+
+        xGroup.start(xTaskGetTickCount());
+        m_pxGroups[m_uxGroupsCount++] = &xGroup;
+        return true;
+    }
+
+    /**
+     * @brief Check all groups once
+     */
+    void check(void)
+    {
+        TickType_t xNow = xTaskGetTickCount();
+        for (uint32_t i = 0u; i < m_uxGroupsCount; i++) {
+            m_pxGroups[i]->update(xNow);
+        }
+    }
+
+    /**
+     * @brief Endless loop of the supervisor Task
+     *
+     * @param xCheckPeriodMs Time between checks
+     */
+    void runForever(size_t xCheckPeriodMs = 1u)
+    {
+        for (;;) {
+            check();
+            vTaskDelay(pdMS_TO_TICKS(xCheckPeriodMs) ? pdMS_TO_TICKS(xCheckPeriodMs) : 1u);
+        }
+    }
+};
+#endif // configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_BUDGET_HPP
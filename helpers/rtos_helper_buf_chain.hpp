@@ -0,0 +1,671 @@
+/**
+ * @file rtos_helper_buf_chain.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_BUF_CHAIN_HPP
+#define _RTOS_HELPER_BUF_CHAIN_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_lf_stack.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Header of every segment, its data follows right after it
+typedef struct os_buf_segment_t {
+    struct os_buf_segment_t* pxNext;
+    uint16_t usOffset; // Start of data inside of the segment
+    uint16_t usLength; // Amount of data bytes
+} os_buf_segment_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Untyped part of @ref OSBufferPool
+ *
+ * @note Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSBufferPoolBase
+{
+private:
+    uint8_t* m_pucStorage = nullptr;
+    uint32_t m_uxStride = 0u;
+    uint32_t m_uxCount = 0u;
+    uint16_t m_usSegmentSize = 0u;
+    uint16_t m_usHeadroom = 0u;
+
+    // Free segments by index, no lock on alloc and free where OSAtomic is native
+    OSLockFreeStackBase m_xFree;
+    OSAtomic<uint32_t> m_uxFreeCount;
+
+    os_buf_segment_t* _getSegment(uint32_t uxIndex)
+    {
+        return reinterpret_cast<os_buf_segment_t*>(&m_pucStorage[uxIndex * m_uxStride]);
+    }
+
+protected:
+    // Only @ref OSBufferPool is allowed to create it, as it holds the storage
+    OSBufferPoolBase(uint8_t* pucStorage, OSAtomic<uint32_t>* pxLinks, uint32_t uxStride,
+                     uint32_t uxCount, uint16_t usSegmentSize, uint16_t usHeadroom)
+                                : m_pucStorage(pucStorage), m_uxStride(uxStride), m_uxCount(uxCount),
+                                m_usSegmentSize(usSegmentSize), m_usHeadroom(usHeadroom),
+                                m_xFree(pxLinks, uxCount) {};
+
+    // Put every segment into the free list, must be called once storage is constructed
+    void _reset(void)
+    {
+        for (uint32_t i = m_uxCount; i > 0u; i--) {
+            m_xFree.pushIndex(i - 1u);
+        }
+        m_uxFreeCount.store(m_uxCount);
+    }
+
+public:
+    /**
+     * @brief Take an empty segment
+     *
+     * @retval Segment, nullptr if pool is exhausted
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION os_buf_segment_t* alloc(void)
+    {
+        uint32_t uxIndex = m_xFree.popIndex();
+        if (uxIndex == OS_LOCK_FREE_STACK_EMPTY) {
+            return nullptr;
+        }
+        m_uxFreeCount.fetchSub(1u);
+
+        os_buf_segment_t* pxSegment = _getSegment(uxIndex);
+        pxSegment->pxNext = nullptr;
+        pxSegment->usOffset = 0u;
+        pxSegment->usLength = 0u;
+        return pxSegment;
+    }
+
+    /**
+     * @brief Give back a list of segments
+     *
+     * @param pxHead First segment, all linked after it are freed too
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION void free(os_buf_segment_t* pxHead)
+    {
+        while (pxHead != nullptr) {
+            // Link is read first, segment may be taken again right after the push
+            os_buf_segment_t* pxNext = pxHead->pxNext;
+            uint32_t uxOffset = (uint32_t)(reinterpret_cast<uint8_t*>(pxHead) - m_pucStorage);
+
+            assert(((uxOffset % m_uxStride) == 0u) && ((uxOffset / m_uxStride) < m_uxCount));
+            m_uxFreeCount.fetchAdd(1u);
+            m_xFree.pushIndex(uxOffset / m_uxStride);
+            pxHead = pxNext;
+        }
+    }
+
+    /**
+     * @brief Get data area of the segment
+     */
+    static uint8_t* getData(os_buf_segment_t* pxSegment)
+    {
+        return reinterpret_cast<uint8_t*>(pxSegment) + sizeof(os_buf_segment_t);
+    }
+
+    /**
+     * @brief Get capacity of every segment
+     */
+    uint16_t getSegmentSize(void)
+    {
+        return m_usSegmentSize;
+    }
+
+    /**
+     * @brief Get space reserved for headers in front of the first segment
+     */
+    uint16_t getHeadroom(void)
+    {
+        return m_usHeadroom;
+    }
+
+    /**
+     * @brief Get amount of free segments
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getFreeCount(void)
+    {
+        return m_uxFreeCount.load();
+    }
+};
+
+
+/**
+ * @brief Static pool of fixed-size segments for @ref OSBufferChain
+ *
+ * @tparam SegmentSize Capacity of every segment in bytes
+ * @tparam Count Amount of segments
+ * @tparam Headroom Bytes left free in front of a new chain for headers
+ *
+ * @note This class is thread-safe and an ISR safe
+ */
+template <uint32_t SegmentSize, uint32_t Count, uint32_t Headroom = 0u>
+class OSBufferPool : public OSBufferPoolBase
+{
+    static_assert((SegmentSize != 0u) && (SegmentSize <= UINT16_MAX), "SegmentSize must be 1..65535");
+    static_assert(Headroom < SegmentSize, "Headroom must be less than SegmentSize");
+    static_assert((Count != 0u) && (Count <= OS_LOCK_FREE_STACK_MAX), "Count must be 1..OS_LOCK_FREE_STACK_MAX");
+
+private:
+    // Data is padded, so every header stays aligned
+    static constexpr uint32_t Stride = sizeof(os_buf_segment_t) +
+        ((SegmentSize + alignof(os_buf_segment_t) - 1u) & ~(uint32_t)(alignof(os_buf_segment_t) - 1u));
+
+    alignas(os_buf_segment_t) uint8_t m_ucStorage[Stride * Count];
+    OSAtomic<uint32_t> m_uxLinks[Count];
+
+public:
+    OSBufferPool() : OSBufferPoolBase(m_ucStorage, m_uxLinks, Stride, Count, SegmentSize, Headroom)
+    {
+        _reset();
+    };
+
+    /**
+     * @brief Get amount of segments
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return Count;
+    }
+};
+
+
+/**
+ * @brief Payload scattered over linked segments of @ref OSBufferPool
+ *
+ * Every stage of the stack adds or strips its header in place,
+ * payload bytes are never moved. Chain is passed between Tasks
+ * as a single pointer to its first segment.
+ *
+ * @code{cpp}
+ * OSBufferPool<128, 32, 16> Segments;
+ * OSQueue<8, os_buf_segment_t*> toRouter;
+ * ...
+ * // Radio Task
+ * OSBufferChain frame(Segments);
+ * frame.append(rxData, rxLen);
+ * os_buf_segment_t* pxHead = frame.detach();
+ * if (!toRouter.send(pxHead, 0)) {
+ *     Segments.free(pxHead);
+ * }
+ * ...
+ * // Router Task
+ * os_buf_segment_t* pxHead;
+ * toRouter.receive(pxHead);
+ * OSBufferChain frame(Segments, pxHead);
+ * frame.strip(sizeof(RadioHeader));
+ * frame.prepend(&routeHeader, sizeof(routeHeader));
+ * @endcode
+ *
+ * @note 1. Chain is owned by a single Task at a time, it is NOT thread-safe.
+ * @note 2. Segments go back to the pool on destruction, unless detached.
+ */
+class OSBufferChain
+{
+private:
+    OSBufferPoolBase* m_pxPool = nullptr;
+    os_buf_segment_t* m_pxHead = nullptr;
+    os_buf_segment_t* m_pxTail = nullptr;
+    uint32_t m_uxLength = 0u;
+
+public:
+    /**
+     * @param xPool Pool of the segments
+     * @param pxHead Detached chain to take ownership of, if any
+     */
+    OSBufferChain(OSBufferPoolBase& xPool, os_buf_segment_t* pxHead = nullptr) : m_pxPool(&xPool)
+    {
+        attach(pxHead);
+    };
+
+    ~OSBufferChain()
+    {
+        clear();
+    };
+
+    OSBufferChain(const OSBufferChain&) = delete;
+    OSBufferChain& operator=(const OSBufferChain&) = delete;
+
+    /**
+     * @brief Take ownership of detached segments
+     *
+     * @param pxHead First segment, returned by @ref detach()
+     *
+     * @note Current content is freed
+     */
+    void attach(os_buf_segment_t* pxHead)
+    {
+        clear();
+
+        m_pxHead = pxHead;
+        for (os_buf_segment_t* pxIt = pxHead; pxIt != nullptr; pxIt = pxIt->pxNext) {
+            m_uxLength += pxIt->usLength;
+            m_pxTail = pxIt;
+        }
+    }
+
+    /**
+     * @brief Give up ownership, e.g. to send the chain to another Task
+     *
+     * @retval First segment, nullptr if chain is empty
+     */
+    os_buf_segment_t* detach(void)
+    {
+        os_buf_segment_t* pxHead = m_pxHead;
+
+        m_pxHead = nullptr;
+        m_pxTail = nullptr;
+        m_uxLength = 0u;
+        return pxHead;
+    }
+
+    /**
+     * @brief Return all segments to the pool
+     */
+    void clear(void)
+    {
+        m_pxPool->free(detach());
+    }
+
+    /**
+     * @brief Copy data to the end of the chain
+     *
+     * @param pvData Data to copy
+     * @param uxSize Amount of bytes
+     *
+     * @return "true" if successful, "false" if pool is exhausted
+     *
+     * @note On failure chain is left untouched
+     */
+    bool append(const void* pvData, uint32_t uxSize)
+    {
+        const uint8_t* pucData = static_cast<const uint8_t*>(pvData);
+        const uint32_t uxSegmentSize = m_pxPool->getSegmentSize();
+
+        uint32_t uxRoom = 0u;
+        if (m_pxTail != nullptr) {
+            uxRoom = uxSegmentSize - m_pxTail->usOffset - m_pxTail->usLength;
+        }
+
+        // Every segment is taken first, so running out of them changes nothing
+        os_buf_segment_t* pxFirst = nullptr;
+        os_buf_segment_t* pxLast = nullptr;
+        if (uxSize > uxRoom) {
+            uint32_t uxLeft = uxSize - uxRoom;
+            uint32_t uxOffset = (m_pxTail == nullptr) ? m_pxPool->getHeadroom() : 0u;
+
+            while (uxLeft != 0u) {
+                os_buf_segment_t* pxSegment = m_pxPool->alloc();
+                if (pxSegment == nullptr) {
+                    m_pxPool->free(pxFirst);
+                    return false;
+                }
+
+                pxSegment->usOffset = (uint16_t)uxOffset;
+                if (pxLast == nullptr) {
+                    pxFirst = pxSegment;
+                } else {
+                    pxLast->pxNext = pxSegment;
+                }
+                pxLast = pxSegment;
+
+                uint32_t uxChunk = uxSegmentSize - uxOffset;
+                uxLeft -= (uxChunk < uxLeft) ? uxChunk : uxLeft;
+                uxOffset = 0u;
+            }
+        }
+
+        m_uxLength += uxSize;
+
+        if (uxRoom != 0u) {
+            uint32_t uxChunk = (uxRoom < uxSize) ? uxRoom : uxSize;
+            memcpy(&OSBufferPoolBase::getData(m_pxTail)[m_pxTail->usOffset + m_pxTail->usLength],
+                   pucData, uxChunk);
+            m_pxTail->usLength += (uint16_t)uxChunk;
+            pucData += uxChunk;
+            uxSize -= uxChunk;
+        }
+
+        for (os_buf_segment_t* pxIt = pxFirst; pxIt != nullptr; pxIt = pxIt->pxNext) {
+            uint32_t uxChunk = uxSegmentSize - pxIt->usOffset;
+            uxChunk = (uxChunk < uxSize) ? uxChunk : uxSize;
+            memcpy(&OSBufferPoolBase::getData(pxIt)[pxIt->usOffset], pucData, uxChunk);
+            pxIt->usLength = (uint16_t)uxChunk;
+            pucData += uxChunk;
+            uxSize -= uxChunk;
+        }
+
+        if (pxFirst != nullptr) {
+            if (m_pxTail == nullptr) {
+                m_pxHead = pxFirst;
+            } else {
+                m_pxTail->pxNext = pxFirst;
+            }
+            m_pxTail = pxLast;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get contiguous space in front of the data, e.g. for a header
+     *
+     * @param uxSize Amount of bytes, not more than segment size
+     *
+     * @retval Where to write the header, nullptr if pool is exhausted
+     *
+     * @note Uses headroom of the first segment, a new one is linked only if it's too small
+     */
+    uint8_t* prepend(uint32_t uxSize)
+    {
+        assert(uxSize <= m_pxPool->getSegmentSize());
+        if (uxSize > m_pxPool->getSegmentSize()) {
+            return nullptr;
+        }
+
+        if ((m_pxHead == nullptr) || (m_pxHead->usOffset < uxSize)) {
+            os_buf_segment_t* pxSegment = m_pxPool->alloc();
+            if (pxSegment == nullptr) {
+                return nullptr;
+            }
+
+            // Placed at the end, so next header fits in front of it too
+            pxSegment->usOffset = (uint16_t)m_pxPool->getSegmentSize();
+            pxSegment->pxNext = m_pxHead;
+            m_pxHead = pxSegment;
+            if (m_pxTail == nullptr) {
+                m_pxTail = pxSegment;
+            }
+        }
+
+        m_pxHead->usOffset -= (uint16_t)uxSize;
+        m_pxHead->usLength += (uint16_t)uxSize;
+        m_uxLength += uxSize;
+        return &OSBufferPoolBase::getData(m_pxHead)[m_pxHead->usOffset];
+    }
+
+    /**
+     * @brief Copy a header in front of the data
+     *
+     * @param pvData Header to copy
+     * @param uxSize Amount of bytes, not more than segment size
+     *
+     * @return "true" if successful, "false" if pool is exhausted
+     */
+    bool prepend(const void* pvData, uint32_t uxSize)
+    {
+        uint8_t* pucDst = prepend(uxSize);
+        if (pucDst == nullptr) {
+            return false;
+        }
+
+        memcpy(pucDst, pvData, uxSize);
+        return true;
+    }
+
+    /**
+     * @brief Access the first bytes in place, e.g. to parse a header
+     *
+     * @param uxSize Amount of bytes
+     *
+     * @retval Pointer to the data, nullptr if they are not in the first segment
+     */
+    uint8_t* front(uint32_t uxSize)
+    {
+        if ((m_pxHead == nullptr) || (m_pxHead->usLength < uxSize)) {
+            return nullptr;
+        }
+
+        return &OSBufferPoolBase::getData(m_pxHead)[m_pxHead->usOffset];
+    }
+
+    /**
+     * @brief Drop bytes from the front, e.g. a parsed header
+     *
+     * @param uxSize Amount of bytes
+     *
+     * @return "true" if successful, "false" if chain is shorter
+     *
+     * @note Emptied segments go back to the pool at once
+     */
+    bool strip(uint32_t uxSize)
+    {
+        if (uxSize > m_uxLength) {
+            return false;
+        }
+
+        m_uxLength -= uxSize;
+        while (uxSize != 0u) {
+            os_buf_segment_t* pxSegment = m_pxHead;
+
+            if (pxSegment->usLength > uxSize) {
+                pxSegment->usOffset += (uint16_t)uxSize;
+                pxSegment->usLength -= (uint16_t)uxSize;
+                break;
+            }
+
+            uxSize -= pxSegment->usLength;
+            m_pxHead = pxSegment->pxNext;
+            pxSegment->pxNext = nullptr;
+            m_pxPool->free(pxSegment);
+        }
+
+        if (m_pxHead == nullptr) {
+            m_pxTail = nullptr;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gather data into a flat buffer
+     *
+     * @param uxOffset Position of the first byte to copy
+     * @param pvData Where to copy
+     * @param uxSize Max amount of bytes
+     *
+     * @retval Amount of copied bytes
+     */
+    uint32_t copyOut(uint32_t uxOffset, void* pvData, uint32_t uxSize) const
+    {
+        uint8_t* pucDst = static_cast<uint8_t*>(pvData);
+        uint32_t uxCopied = 0u;
+
+        for (os_buf_segment_t* pxIt = m_pxHead; (pxIt != nullptr) && (uxCopied < uxSize); pxIt = pxIt->pxNext) {
+            if (uxOffset >= pxIt->usLength) {
+                uxOffset -= pxIt->usLength;
+                continue;
+            }
+
+            uint32_t uxChunk = pxIt->usLength - uxOffset;
+            if (uxChunk > (uxSize - uxCopied)) {
+                uxChunk = uxSize - uxCopied;
+            }
+
+            memcpy(&pucDst[uxCopied], &OSBufferPoolBase::getData(pxIt)[pxIt->usOffset + uxOffset], uxChunk);
+            uxCopied += uxChunk;
+            uxOffset = 0u;
+        }
+
+        return uxCopied;
+    }
+
+    /**
+     * @brief Move everything after the position to another chain
+     *
+     * @param uxOffset Position of the first byte of the second part
+     * @param xRest Empty chain of the same pool, receives the second part
+     *
+     * @return "true" if successful, "false" if position is wrong or pool is exhausted
+     *
+     * @note Only a segment cut in the middle is copied, at most one segment of data
+     */
+    bool split(uint32_t uxOffset, OSBufferChain& xRest)
+    {
+        assert((xRest.m_pxPool == m_pxPool) && (xRest.m_pxHead == nullptr));
+        if ((xRest.m_pxPool != m_pxPool) || (xRest.m_pxHead != nullptr) || (uxOffset > m_uxLength)) {
+            return false;
+        }
+
+        if (uxOffset == m_uxLength) {
+            return true;
+        }
+
+        os_buf_segment_t* pxPrev = nullptr;
+        os_buf_segment_t* pxIt = m_pxHead;
+        uint32_t uxInner = uxOffset;
+        while (uxInner >= pxIt->usLength) {
+            uxInner -= pxIt->usLength;
+            pxPrev = pxIt;
+            pxIt = pxIt->pxNext;
+        }
+
+        os_buf_segment_t* pxRestHead = pxIt;
+        os_buf_segment_t* pxRestTail = m_pxTail;
+
+        if (uxInner == 0u) {
+            // Cut on the boundary, nothing to copy
+            if (pxPrev == nullptr) {
+                m_pxHead = nullptr;
+            } else {
+                pxPrev->pxNext = nullptr;
+            }
+            m_pxTail = pxPrev;
+        } else {
+            os_buf_segment_t* pxSegment = m_pxPool->alloc();
+            if (pxSegment == nullptr) {
+                return false;
+            }
+
+            // Same position inside of the segment, so its headroom is kept
+            pxSegment->usOffset = pxIt->usOffset + (uint16_t)uxInner;
+            pxSegment->usLength = pxIt->usLength - (uint16_t)uxInner;
+            memcpy(&OSBufferPoolBase::getData(pxSegment)[pxSegment->usOffset],
+                   &OSBufferPoolBase::getData(pxIt)[pxSegment->usOffset], pxSegment->usLength);
+
+            pxSegment->pxNext = pxIt->pxNext;
+            pxIt->usLength = (uint16_t)uxInner;
+            pxIt->pxNext = nullptr;
+
+            pxRestHead = pxSegment;
+            if (pxRestTail == pxIt) {
+                pxRestTail = pxSegment;
+            }
+            m_pxTail = pxIt;
+        }
+
+        xRest.m_pxHead = pxRestHead;
+        xRest.m_pxTail = pxRestTail;
+        xRest.m_uxLength = m_uxLength - uxOffset;
+        m_uxLength = uxOffset;
+        return true;
+    }
+
+    /**
+     * @brief Move all segments of another chain to the end of this one
+     *
+     * @param xOther Chain of the same pool, left empty
+     *
+     * @note No data is copied
+     */
+    void concat(OSBufferChain& xOther)
+    {
+        assert(xOther.m_pxPool == m_pxPool);
+        if ((xOther.m_pxPool != m_pxPool) || (xOther.m_pxHead == nullptr)) {
+            return;
+        }
+
+        if (m_pxTail == nullptr) {
+            m_pxHead = xOther.m_pxHead;
+        } else {
+            m_pxTail->pxNext = xOther.m_pxHead;
+        }
+        m_pxTail = xOther.m_pxTail;
+        m_uxLength += xOther.m_uxLength;
+
+        xOther.detach();
+    }
+
+    /**
+     * @brief Visit every contiguous span of data, e.g. to feed a DMA or CRC
+     *
+     * @param xVisitor Callable with (const uint8_t* pucData, uint32_t uxSize) arguments
+     */
+    template <class Visitor>
+    void forEachSpan(Visitor xVisitor) const
+    {
+        for (os_buf_segment_t* pxIt = m_pxHead; pxIt != nullptr; pxIt = pxIt->pxNext) {
+            if (pxIt->usLength != 0u) {
+                xVisitor(&OSBufferPoolBase::getData(pxIt)[pxIt->usOffset], (uint32_t)pxIt->usLength);
+            }
+        }
+    }
+
+    /**
+     * @brief Get total amount of data bytes
+     */
+    uint32_t getLength(void) const
+    {
+        return m_uxLength;
+    }
+
+    /**
+     * @brief Check if there is no data
+     */
+    bool isEmpty(void) const
+    {
+        return (m_uxLength == 0u);
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_BUF_CHAIN_HPP
@@ -0,0 +1,276 @@
+/**
+ * @file rtos_helper_condvar.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_CONDVAR_HPP
+#define _RTOS_HELPER_CONDVAR_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_mutex.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+#if ((configUSE_MUTEXES == 1) && (configUSE_TASK_NOTIFICATIONS == 1) && \
+     (INCLUDE_xTaskGetCurrentTaskHandle == 1))
+/**
+ * @brief Condition variable for state protected by @ref OSMutex
+ *
+ * Waiters are linked into an intrusive list right on their own stacks
+ * and sleep on a Task notification, so there is no allocation
+ * and a waiter wakes up as soon as it's notified.
+ *
+ * @code{cpp}
+ * OSMutex queueMutex;
+ * OSConditionVariable queueChanged;
+ * uint32_t itemsCount = 0;
+ * ...
+ * // Consumer
+ * queueMutex.lock();
+ * queueChanged.wait(queueMutex, [] { return itemsCount > 0; });
+ * itemsCount--;
+ * queueMutex.unlock();
+ * ...
+ * // Producer
+ * queueMutex.lock();
+ * itemsCount++;
+ * queueMutex.unlock();
+ * queueChanged.notifyOne();
+ * @endcode
+ *
+ * @note 1. Waiters sleep on OS_HELPER_NOTIFY_INDEX notification.
+ * @note 2. Waiters are woken up in FIFO order.
+ * @note 3. Do not use it inside ISR context!
+ */
+class OSConditionVariable
+{
+private:
+    typedef struct os_condvar_waiter_t {
+        TaskHandle_t xTask;
+        struct os_condvar_waiter_t* pxNext;
+        // Set by notifier once waiter is unlinked from the list
+        volatile bool bSignaled;
+    } os_condvar_waiter_t;
+
+    os_condvar_waiter_t* m_pxHead = nullptr;
+    os_condvar_waiter_t* m_pxTail = nullptr;
+    uint32_t m_uxWaiters = 0u;
+
+    OSCriticalSection m_xLock;
+
+    // Must be called inside of critical section
+    void _unlink(os_condvar_waiter_t* pxWaiter)
+    {
+        os_condvar_waiter_t* pxPrev = nullptr;
+
+        for (os_condvar_waiter_t* pxIt = m_pxHead; pxIt != nullptr; pxIt = pxIt->pxNext) {
+            if (pxIt == pxWaiter) {
+                if (pxPrev == nullptr) {
+                    m_pxHead = pxIt->pxNext;
+                } else {
+                    pxPrev->pxNext = pxIt->pxNext;
+                }
+
+                if (m_pxTail == pxIt) {
+                    m_pxTail = pxPrev;
+                }
+                m_uxWaiters--;
+                return;
+            }
+            pxPrev = pxIt;
+        }
+    }
+
+
+public:
+    OSConditionVariable() {};
+
+    /**
+     * @brief Release the Mutex and wait for notification
+     *
+     * @param xMutex Mutex taken by the caller, it's taken again on return
+     * @param xMsToWait Max time to wait
+     *
+     * @return "true" if notified, "false" on timeout
+     *
+     * @note State might be changed again before Mutex is taken,
+     *       so check it in a loop or use predicate version
+     */
+    bool wait(OSMutex& xMutex, size_t xMsToWait = portMAX_DELAY_MS)
+    {
+        os_condvar_waiter_t xWaiter = {xTaskGetCurrentTaskHandle(), nullptr, false};
+
+        // Linked before Mutex is released, so notification can't be lost
+        UBaseType_t uxStatus = m_xLock.enter();
+        if (m_pxTail == nullptr) {
+            m_pxHead = &xWaiter;
+        } else {
+            m_pxTail->pxNext = &xWaiter;
+        }
+        m_pxTail = &xWaiter;
+        m_uxWaiters++;
+        m_xLock.exit(uxStatus);
+
+        xMutex.unlock();
+
+        OS_HELPER_SCHED_POINT();
+
+        TickType_t xTicks = (xMsToWait == portMAX_DELAY_MS) ? portMAX_DELAY : pdMS_TO_TICKS(xMsToWait);
+        bool taken = (ulTaskNotifyTakeIndexed(OS_HELPER_NOTIFY_INDEX, pdTRUE, xTicks) != 0u);
+
+        // Only the flag tells if notifier has unlinked the node
+        uxStatus = m_xLock.enter();
+        bool signaled = xWaiter.bSignaled;
+        if (!signaled) {
+            _unlink(&xWaiter);
+        }
+        m_xLock.exit(uxStatus);
+
+        if (signaled && !taken) {
+            // Timed out right when notifier unlinked the node, its notification
+            // is about to come, take it, otherwise it's left for the next wait
+            ulTaskNotifyTakeIndexed(OS_HELPER_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        }
+
+        xMutex.lock();
+        return signaled;
+    }
+
+    /**
+     * @brief Wait till predicate becomes "true"
+     *
+     * @param xMutex Mutex taken by the caller and protecting the state
+     * @param xPred Callable returning "true" when state is as expected
+     * @param xMsToWait Max time to wait in total
+     *
+     * @return Result of the predicate, "false" only on timeout
+     */
+    template <class Predicate>
+    bool wait(OSMutex& xMutex, Predicate xPred, size_t xMsToWait = portMAX_DELAY_MS)
+    {
+        if (xMsToWait == portMAX_DELAY_MS) {
+            while (!xPred()) {
+                wait(xMutex);
+            }
+            return true;
+        }
+
+        const TickType_t xTimeout = pdMS_TO_TICKS(xMsToWait);
+        const TickType_t xStart = xTaskGetTickCount();
+
+        while (!xPred()) {
+            TickType_t xElapsed = xTaskGetTickCount() - xStart;
+            if (xElapsed >= xTimeout) {
+                return false;
+            }
+
+            wait(xMutex, (size_t)((xTimeout - xElapsed) * portTICK_PERIOD_MS));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Wake up the longest waiting Task
+     *
+     * @return "true" if there was a waiter
+     *
+     * @note Mutex may be held or not, it's not required
+     */
+    bool notifyOne(void)
+    {
+        OS_HELPER_SCHED_POINT();
+
+        TaskHandle_t xTask = nullptr;
+
+        UBaseType_t uxStatus = m_xLock.enter();
+        os_condvar_waiter_t* pxWaiter = m_pxHead;
+        if (pxWaiter != nullptr) {
+            m_pxHead = pxWaiter->pxNext;
+            if (m_pxHead == nullptr) {
+                m_pxTail = nullptr;
+            }
+            m_uxWaiters--;
+
+            // Node may be gone right after the flag is set, don't touch it later
+            xTask = pxWaiter->xTask;
+            pxWaiter->bSignaled = true;
+        }
+        m_xLock.exit(uxStatus);
+
+        if (xTask == nullptr) {
+            return false;
+        }
+
+        xTaskNotifyGiveIndexed(xTask, OS_HELPER_NOTIFY_INDEX);
+        return true;
+    }
+
+    /**
+     * @brief Wake up all waiting Tasks
+     *
+     * @retval Amount of woken up Tasks
+     *
+     * @note Wakes at most as many Tasks as were waiting when it was called
+     */
+    uint32_t notifyAll(void)
+    {
+        UBaseType_t uxStatus = m_xLock.enter();
+        const uint32_t uxWaiters = m_uxWaiters;
+        m_xLock.exit(uxStatus);
+
+        uint32_t uxCount = 0u;
+        while ((uxCount < uxWaiters) && notifyOne()) {
+            uxCount++;
+        }
+
+        return uxCount;
+    }
+};
+#endif // configUSE_MUTEXES && configUSE_TASK_NOTIFICATIONS && INCLUDE_xTaskGetCurrentTaskHandle
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_CONDVAR_HPP
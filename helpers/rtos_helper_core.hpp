@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -39,6 +42,36 @@
 // This will work with different tick period, tho...
 #define portMAX_DELAY_MS (portMAX_DELAY * portTICK_PERIOD_MS)
 
+// Scheduling point hook.
+// Expanded at the entry of every signalling or blocking helper method.
+// Empty by default, so it costs nothing on target.
+// Host test builds may redefine it (before any helper is included)
+// to force preemption there and explore different Task interleavings.
+// See rtos_helper_sched_explorer.hpp for a seeded implementation.
+#ifndef OS_HELPER_SCHED_POINT
+#define OS_HELPER_SCHED_POINT()
+#endif // OS_HELPER_SCHED_POINT
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Amount of cores known to the kernel.
+// FreeRTOS v11 SMP uses configNUMBER_OF_CORES, older SMP ports use configNUM_CORES.
+#if defined(configNUMBER_OF_CORES)
+#define OS_MCU_CORES_COUNT configNUMBER_OF_CORES
+#elif defined(configNUM_CORES)
+#define OS_MCU_CORES_COUNT configNUM_CORES
+#elif defined(portNUM_PROCESSORS)
+#define OS_MCU_CORES_COUNT portNUM_PROCESSORS
+#else
+#define OS_MCU_CORES_COUNT 1
+#endif
+
+// SMP kernel with arbitrary core affinity masks (RP2040, FreeRTOS v11 SMP, POSIX SMP port)
+#if ((OS_MCU_CORES_COUNT > 1) && defined(configUSE_CORE_AFFINITY) && (configUSE_CORE_AFFINITY == 1))
+#define OS_MCU_ENABLE_AFFINITY_MASK
+#define OS_MCU_ENABLE_MULTICORE_SUPPORT
+#endif
 
 // - - - - - - - - - - - - - - - - - - - - - - - -
 #ifdef RP2040
@@ -51,7 +84,7 @@
 #endif // portNOP
 #endif // xPortInIsrContext
 
-#if ((configNUM_CORES > 1) && (configUSE_CORE_AFFINITY == 1))
+#ifdef OS_MCU_ENABLE_AFFINITY_MASK
 
 #define xTaskCreatePinnedToCore(taskCode, name, stackDepth, parameters,        \
                                 priority, createdTask, coreAffinityMask)       \
@@ -64,8 +97,6 @@
   xTaskCreateStaticAffinitySet(taskCode, name, stackDepth, parameters,         \
                                priority, stackBuffer, taskBuffer,              \
                                1 << coreAffinityMask)
-
-#define OS_MCU_ENABLE_MULTICORE_SUPPORT
 #endif
 #endif
 
@@ -77,6 +108,8 @@
 #endif // XT_NOP
 
 #define OS_MCU_ENABLE_MULTICORE_SUPPORT
+#include "esp_attr.h"
+#include "esp_idf_version.h"
 #endif // ESP32
 
 // - - - - - - - - - - - - - - - - - - - - - - - -
@@ -93,6 +126,70 @@ typedef enum {
 } os_mcu_core_num_t;
 #endif // OS_MCU_ENABLE_MULTICORE_SUPPORT
 
+// Set of cores allowed to run a Task, bit N is core N.
+// Scales to any configNUMBER_OF_CORES, unlike @ref os_mcu_core_num_t.
+typedef UBaseType_t os_mcu_core_mask_t;
+
+#define OS_MCU_CORE_MASK(core) ((os_mcu_core_mask_t)1u << (core))
+#define OS_MCU_CORE_MASK_ANY   (~(os_mcu_core_mask_t)0u) // Same as tskNO_AFFINITY
+
+// Task currently running on the given core
+#if (OS_MCU_CORES_COUNT > 1)
+#if (defined(ESP32) || defined(ESP_PLATFORM)) && (ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0))
+#define OS_HELPER_GET_CURRENT_TASK(core) xTaskGetCurrentTaskHandleForCPU(core)
+#else
+#define OS_HELPER_GET_CURRENT_TASK(core) xTaskGetCurrentTaskHandleForCore(core)
+#endif
+#else
+#define OS_HELPER_GET_CURRENT_TASK(core) xTaskGetCurrentTaskHandle()
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ISR context check used by every ISR safe method.
+// Host test builds may redefine it (before any helper is included)
+// to fake ISR context, see rtos_helper_isr_sim.hpp
+#ifndef OS_HELPER_IS_INSIDE_ISR
+#if (__cplusplus >= 201703L)
+#define OS_HELPER_IS_INSIDE_ISR() xPortIsInsideInterrupt()
+#else
+#define OS_HELPER_IS_INSIDE_ISR() xPortInIsrContext()
+#endif // __cplusplus >= 201703L
+#endif // OS_HELPER_IS_INSIDE_ISR
+
+// Context switch request on ISR exit, same override rules as above.
+#ifndef OS_HELPER_YIELD_FROM_ISR
+#define OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus) portYIELD_FROM_ISR(xHigherPriorityStatus)
+#endif // OS_HELPER_YIELD_FROM_ISR
+
+// Task notification index used by blocking helpers (OSRpc, ...),
+// so they do not consume signals of OSTaskBase::emitSignal()/waitSignal().
+// With a single notification entry both share index 0, don't mix them in one Task!
+#ifndef OS_HELPER_NOTIFY_INDEX
+#if (defined(configTASK_NOTIFICATION_ARRAY_ENTRIES) && (configTASK_NOTIFICATION_ARRAY_ENTRIES > 1))
+#define OS_HELPER_NOTIFY_INDEX 1
+#else
+#define OS_HELPER_NOTIFY_INDEX 0
+#endif
+#endif // OS_HELPER_NOTIFY_INDEX
+
+// Placement of every ISR reachable helper method.
+// On ESP32 it's IRAM, so ISR does not suffer from flash cache misses
+// and keeps working while cache is disabled during flash writes.
+// Might be redefined, e.g. to check placement in host builds with nm:
+//   -DOS_HOT_SECTION='__attribute__((section(".text.os_hot")))'
+#ifndef OS_HOT_SECTION
+#if (defined(ESP32) || defined(ESP_PLATFORM))
+#define OS_HOT_SECTION IRAM_ATTR
+#else
+#define OS_HOT_SECTION
+#endif
+#endif // OS_HOT_SECTION
+
+// Lambdas of ISR reachable methods must be inlined into OS_HOT_SECTION code,
+// otherwise they land in default section.
+#define OS_HOT_INLINE __attribute__((always_inline))
+
 // - - - - - - - - - - - - - - - - - - - - - - - -
 
 /* -------------------------------------------------------------- */
@@ -104,15 +201,15 @@ typedef enum {
 #if (__cplusplus >= 201703L)
 
 // It will yield ONLY if it requred by status !
-const auto yieldFunc = [&](BaseType_t* status) {portYIELD_FROM_ISR(*status);};
+const auto yieldFunc = [](BaseType_t* status) OS_HOT_INLINE {OS_HELPER_YIELD_FROM_ISR(*status);};
 
 
 // Generic lambda
 // Execute "a" only if context is not in ISR, "b" if yes
-const auto execIsrFunc = [&](auto a, auto b)
+const auto execIsrFunc = [](auto a, auto b) OS_HOT_INLINE
 {
     BaseType_t xHigherPriorityStatus = pdFALSE;
-    return (xPortIsInsideInterrupt() == pdFALSE) ? a() : b(&xHigherPriorityStatus, yieldFunc);
+    return (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) ? a() : b(&xHigherPriorityStatus, yieldFunc);
 };
 
 #endif // __cplusplus >= 201703L
@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "semphr.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -74,10 +77,10 @@
  * ...
  * @endcode
  */
-template <size_t MaxCount> class Counter
+class CounterBase
 {
 private:
-    size_t m_MaxCount = MaxCount;
+    size_t m_MaxCount = 0u;
 
     // An OS object handler.
     SemaphoreHandle_t m_xCounter = nullptr;
@@ -90,10 +93,12 @@ private:
     StaticSemaphore_t m_xSemaphoreControlBlock;
 #endif
 
-public:
-    Counter(){};
+protected:
+    // Only @ref Counter is allowed to create it
+    CounterBase(size_t MaxCount) : m_MaxCount(MaxCount){};
 
-    ~Counter()
+public:
+    ~CounterBase()
     {
         assert(m_xCounter);
         vSemaphoreDelete(m_xCounter);
@@ -151,7 +156,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool take(size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_SECTION bool take(size_t xMsToWait = portMAX_DELAY_MS)
     {
         assert(m_xCounter);
         assert(m_initialized == true);
@@ -160,10 +165,12 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xSemaphoreTake(m_xCounter, pdMS_TO_TICKS(xMsToWait));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xSemaphoreTakeFromISR(m_xCounter, status);
             yieldFunc(status);
             return res;
@@ -171,14 +178,14 @@ public:
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xSemaphoreTake(m_xCounter, xMsToWait);
     } else {
       BaseType_t xHigherPriorityStatus = pdFALSE;
       res = xSemaphoreTakeFromISR(m_xCounter, &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
@@ -194,7 +201,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool give()
+    OS_HOT_SECTION bool give()
     {
         assert(m_xCounter);
         assert(m_initialized == true);
@@ -203,10 +210,12 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xSemaphoreGive(m_xCounter);
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xSemaphoreGiveFromISR(m_xCounter, status);
             yieldFunc(status);
             return res;
@@ -214,14 +223,14 @@ public:
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xSemaphoreGive(m_xCounter);
     } else {
       BaseType_t xHigherPriorityStatus = pdFALSE;
       res = xSemaphoreGiveFromISR(m_xCounter, &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
@@ -237,7 +246,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe (?)
     */
-    bool reset()
+    OS_HOT_SECTION bool reset()
     {
         assert(m_xCounter);
         assert(m_initialized == true);
@@ -247,11 +256,11 @@ public:
         }
 
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             while (xSemaphoreTake(m_xCounter, 0u))
                 ;
             return pdTRUE;
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             // This part is entirely wrong. Have to rewrite it someday...
             while (xSemaphoreTakeFromISR(m_xCounter, status))
                 ;
@@ -259,7 +268,7 @@ public:
             return pdTRUE;
         });
 #else
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       while (xSemaphoreTake(m_xCounter, 1UL))
         ;
         return true;
@@ -270,7 +279,7 @@ public:
         ;
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
 
       return true;
@@ -281,6 +290,18 @@ public:
         // return (bool)xQueueReset(m_xCounter);
     }
 };
+
+
+/**
+ * @brief Template class for Counter, see @ref CounterBase for all methods
+ *
+ * Only sets max count, so all the code is shared between different counts.
+ */
+template <size_t MaxCount> class Counter : public CounterBase
+{
+public:
+    Counter() : CounterBase(MaxCount){};
+};
 #endif // configUSE_COUNTING_SEMAPHORES
 
 // - - - - - - - - - - - - - - - - - - - - - - - -
@@ -0,0 +1,362 @@
+/**
+ * @file rtos_helper_cyclic.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_CYCLIC_HPP
+#define _RTOS_HELPER_CYCLIC_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_task.hpp"
+#include "rtos_helper_timestamp.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Slot is executed in minor frame N
+#define OS_CYCLIC_FRAME(n) (1UL << (n))
+// Slot is executed in every minor frame
+#define OS_CYCLIC_EVERY_FRAME (0xFFFFFFFFUL)
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Step function executed by the cyclic executive, must not block
+ */
+typedef void (*os_cyclic_step_t)(void);
+
+/**
+ * @brief Entry of the schedule table
+ */
+typedef struct {
+    os_cyclic_step_t pxStep; // Step to execute
+    uint32_t uxFrames;       // Mask of minor frames, see OS_CYCLIC_FRAME()
+} os_cyclic_slot_t;
+
+
+/**
+ * @brief Table-driven time-triggered cyclic executive
+ *
+ * Major cycle consists of Frames minor frames, MinorFrameMs each.
+ * In every minor frame all slots of the table marked for this frame
+ * are executed in table order, then host Task sleeps till
+ * the start of the next frame with @ref OSTaskBase::syncWait().
+ * Everything runs in a single Task, so steps need no synchronisation.
+ *
+ * @code{cpp}
+ * constexpr os_cyclic_slot_t kSchedule[] = {
+ *     {readSensors,  OS_CYCLIC_EVERY_FRAME},
+ *     {controlLoop,  OS_CYCLIC_EVERY_FRAME},
+ *     {updateFilter, OS_CYCLIC_FRAME(0) | OS_CYCLIC_FRAME(2)},
+ *     {sendTelemetry, OS_CYCLIC_FRAME(3)},
+ * };
+ * typedef OSCyclicExecutive<5u, 4u> Executive; // 5ms minor, 20ms major
+ * static_assert(Executive::isValid(kSchedule), "Bad schedule");
+ *
+ * OSTask <4096> ExecutiveTask(vExecutiveTask, "Cyclic", nullptr, configMAX_PRIORITIES - 1);
+ * Executive Cyclic(ExecutiveTask, kSchedule);
+ *
+ * void vExecutiveTask(void* pvArg)
+ * {
+ *     Cyclic.runForever();
+ * }
+ * @endcode
+ *
+ * @tparam MinorFrameMs Length of minor frame in milliseconds, multiple of tick period
+ * @tparam Frames Amount of minor frames in major cycle (1..32)
+ * @tparam MaxSlots Max amount of slots in the table
+ *
+ * @note 1. Host Task should have the highest priority to keep jitter low.
+ * @note 2. On multi-core MCU pin host Task to a single core,
+ *          as execution time is measured with per-core cycle counter.
+ * @note 3. Overrun policy of @ref runForever(): frames whose start time has
+ *          already passed are skipped (not executed late), next frame starts
+ *          on its own boundary of the original time grid. So frame index
+ *          always matches real time and one long frame is one overrun,
+ *          not a burst of late back to back frames.
+ */
+template <uint32_t MinorFrameMs, uint32_t Frames, uint32_t MaxSlots = 16u>
+class OSCyclicExecutive
+{
+    static_assert((Frames != 0u) && (Frames <= 32u), "Frames must be in range 1..32");
+    static_assert(MinorFrameMs != 0u, "MinorFrameMs must not be 0");
+
+private:
+    OSTaskBase& m_xHost;
+    const os_cyclic_slot_t* m_pxTable = nullptr;
+    uint32_t m_uxSlots = 0u;
+
+    // Worst measured execution time of every slot and of a whole frame
+    uint32_t m_uxSlotWcet[MaxSlots];
+    uint32_t m_uxFrameWcet = 0u;
+
+    uint32_t m_uxFrame = 0u;
+    uint32_t m_uxMajorCycles = 0u;
+    uint32_t m_uxOverruns = 0u;
+    uint32_t m_uxSkipped = 0u;
+
+    // Called from the host Task when frame took longer than MinorFrameMs
+    void (*m_pxOverrunCallback)(uint32_t uxFrame) = nullptr;
+
+    static constexpr bool _isSlotValid(const os_cyclic_slot_t& xSlot)
+    {
+        return (xSlot.pxStep != nullptr) &&
+               ((xSlot.uxFrames & ((Frames == 32u) ? 0xFFFFFFFFUL : ((1UL << Frames) - 1UL))) != 0u);
+    }
+
+    // Move frame index forward, counting major cycles
+    void _advance(uint32_t uxCount)
+    {
+        m_uxFrame += uxCount;
+        m_uxMajorCycles += m_uxFrame / Frames;
+        m_uxFrame %= Frames;
+    }
+
+    template <size_t N>
+    static constexpr bool _isValidFrom(const os_cyclic_slot_t (&xTable)[N], size_t i)
+    {
+        return (i >= N) || (_isSlotValid(xTable[i]) && _isValidFrom(xTable, i + 1u));
+    }
+
+public:
+    /**
+     * @brief Create executive
+     *
+     * @param xHost Task which will call @ref runForever()
+     * @param xTable Schedule table, must outlive the executive
+     */
+    template <size_t N>
+    OSCyclicExecutive(OSTaskBase& xHost, const os_cyclic_slot_t (&xTable)[N])
+                                : m_xHost(xHost), m_pxTable(xTable), m_uxSlots(N)
+    {
+        static_assert(N <= MaxSlots, "Schedule table is bigger than MaxSlots");
+        resetStats();
+    };
+
+    /**
+     * @brief Check schedule table at compile time
+     *
+     * @retval "true" if every slot has a step and runs in at least one existing frame
+     */
+    template <size_t N>
+    static constexpr bool isValid(const os_cyclic_slot_t (&xTable)[N])
+    {
+        return _isValidFrom(xTable, 0u);
+    }
+
+    /**
+     * @brief Get length of the major cycle in milliseconds
+     */
+    static constexpr uint32_t getMajorCycleMs(void)
+    {
+        return MinorFrameMs * Frames;
+    }
+
+    /**
+     * @brief Set function called when frame overruns
+     *
+     * @param pxCallback Function receiving index of overrun frame
+     *
+     * @note Callback is executed by the host Task, keep it short
+     */
+    void setOverrunCallback(void (*pxCallback)(uint32_t uxFrame))
+    {
+        m_pxOverrunCallback = pxCallback;
+    }
+
+    /**
+     * @brief Execute all slots of the current minor frame
+     *
+     * @retval Execution time of the frame in OSTimestamp units
+     *
+     * @note Only for the host Task or custom loop, see @ref runForever()
+     */
+    uint32_t runFrame(void)
+    {
+        const uint32_t uxFrameBit = OS_CYCLIC_FRAME(m_uxFrame);
+        const uint32_t uxFrameStart = OSTimestamp::now();
+
+        for (uint32_t i = 0u; i < m_uxSlots; i++) {
+            const os_cyclic_slot_t& xSlot = m_pxTable[i];
+            if ((xSlot.uxFrames & uxFrameBit) == 0u) {
+                continue;
+            }
+
+            uint32_t uxStart = OSTimestamp::now();
+            xSlot.pxStep();
+            uint32_t uxTime = OSTimestamp::now() - uxStart;
+
+            if (uxTime > m_uxSlotWcet[i]) {
+                m_uxSlotWcet[i] = uxTime;
+            }
+        }
+
+        uint32_t uxFrameTime = OSTimestamp::now() - uxFrameStart;
+        if (uxFrameTime > m_uxFrameWcet) {
+            m_uxFrameWcet = uxFrameTime;
+        }
+
+        _advance(1u);
+
+        return uxFrameTime;
+    }
+
+    /**
+     * @brief Endless loop of the host Task
+     *
+     * @note Must be called inside of host Task's code !
+     */
+    void runForever(void)
+    {
+        const TickType_t xPeriod = pdMS_TO_TICKS(MinorFrameMs);
+
+        m_xHost.syncWaitInit();
+        // Ideal start of the next frame on the time grid
+        TickType_t xNextStart = xTaskGetTickCount();
+
+        for (;;) {
+            uint32_t uxFrame = m_uxFrame;
+            runFrame();
+            xNextStart += xPeriod;
+
+            // syncWait() returns "false" if start of the next frame is already missed
+            if (m_xHost.syncWait(MinorFrameMs)) {
+                continue;
+            }
+
+            m_uxOverruns++;
+            if (m_pxOverrunCallback != nullptr) {
+                m_pxOverrunCallback(uxFrame);
+            }
+
+            // syncWait() moved its anchor by one period only, next frames would
+            // run back to back. Skip every frame which already had to start.
+            const TickType_t xNow = xTaskGetTickCount();
+            const TickType_t xLate = xNow - xNextStart;
+            uint32_t uxSkip = (uint32_t)((xLate + xPeriod - 1u) / xPeriod);
+            if (uxSkip == 0u) {
+                continue;
+            }
+
+            m_uxSkipped += uxSkip;
+            _advance(uxSkip);
+            xNextStart += (TickType_t)uxSkip * xPeriod;
+
+            // Less than one period, till the next boundary of the grid
+            vTaskDelay(xNextStart - xNow);
+            m_xHost.syncWaitInit();
+            xNextStart = xTaskGetTickCount();
+        }
+    }
+
+    /**
+     * @brief Clear measured execution times and overrun counter
+     */
+    void resetStats(void)
+    {
+        for (uint32_t i = 0u; i < MaxSlots; i++) {
+            m_uxSlotWcet[i] = 0u;
+        }
+        m_uxFrameWcet = 0u;
+        m_uxOverruns = 0u;
+        m_uxSkipped = 0u;
+    }
+
+    /**
+     * @brief Get worst execution time of the slot
+     *
+     * @param uxSlot Index of slot in the table
+     *
+     * @retval Time in nanoseconds
+     */
+    uint64_t getSlotWcetNs(uint32_t uxSlot)
+    {
+        assert(uxSlot < m_uxSlots);
+        return (uxSlot < m_uxSlots) ? OSTimestamp::toNs(m_uxSlotWcet[uxSlot]) : 0u;
+    }
+
+    /**
+     * @brief Get worst execution time of a single minor frame
+     *
+     * @retval Time in nanoseconds
+     */
+    uint64_t getFrameWcetNs(void)
+    {
+        return OSTimestamp::toNs(m_uxFrameWcet);
+    }
+
+    /**
+     * @brief Get amount of frames which did not fit in MinorFrameMs
+     */
+    uint32_t getOverrunCount(void)
+    {
+        return m_uxOverruns;
+    }
+
+    /**
+     * @brief Get amount of frames skipped after overruns, see @ref runForever()
+     */
+    uint32_t getSkippedCount(void)
+    {
+        return m_uxSkipped;
+    }
+
+    /**
+     * @brief Get amount of completed major cycles
+     */
+    uint32_t getMajorCycles(void)
+    {
+        return m_uxMajorCycles;
+    }
+
+    /**
+     * @brief Get amount of slots in the table
+     */
+    uint32_t getSlotsCount(void)
+    {
+        return m_uxSlots;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_CYCLIC_HPP
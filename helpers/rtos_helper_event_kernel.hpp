@@ -0,0 +1,374 @@
+/**
+ * @file rtos_helper_event_kernel.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_EVENT_KERNEL_HPP
+#define _RTOS_HELPER_EVENT_KERNEL_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_ring.hpp"
+#include "rtos_helper_task.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Amount of priorities of event Tasks, one Task per priority
+#define OS_EVENT_KERNEL_PRIORITIES 32u
+
+// Priority of the code which is not an event Task (idle loop of the host)
+#define OS_EVENT_PRIORITY_IDLE 0u
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Handles one queued event of the Task
+ *
+ * @param pvTask Task registered with this function
+ *
+ * @return "true" if Task still has events
+ */
+typedef bool (*os_event_dispatch_t)(void* pvTask);
+
+
+/**
+ * @brief Single-stack kernel of run-to-completion event Tasks
+ *
+ * Every event Task is just a handler function with its own event queue
+ * and a unique priority 1..32. Handlers never block, so they all share
+ * the stack of a single host OSTask (or of a software interrupt)
+ * and preempt each other by plain nested function calls:
+ * event posted to a higher priority Task from a handler runs immediately,
+ * a lower priority one runs as soon as current handler returns.
+ *
+ * Only handlers preempt handlers. Posts from ISR, Timer callbacks
+ * or other Tasks just wake up the host (or call the pend hook),
+ * so a handler being executed at that moment always runs to completion
+ * first, then the highest ready Task is picked.
+ * There is no dispatch on ISR exit like in SST.
+ *
+ * @code{cpp}
+ * OSTask <4096> KernelTask(vKernelTask, "Events", nullptr, configMAX_PRIORITIES - 2);
+ * OSEventKernel Kernel(KernelTask);
+ *
+ * OSEventTask<ButtonEvent, 8> ButtonTask(Kernel, 2u, onButton);
+ * OSEventTask<LedEvent, 4> LedTask(Kernel, 1u, onLed);
+ * ...
+ * void vKernelTask(void* pvArg)
+ * {
+ *     Kernel.runForever();
+ * }
+ * ...
+ * // Any ISR, Task or handler:
+ * ButtonTask.post(ev);
+ * @endcode
+ *
+ * @note 1. Handlers must NOT block, call only non-blocking and ISR safe API.
+ * @note 2. Host stack must fit the deepest chain of nested handlers,
+ *          it's still way less than a stack per Task.
+ * @note 3. Events are handled one by one in FIFO order of every Task.
+ * @note 4. With a pend hook even posts from handlers run in the software interrupt,
+ *          so they are deferred until current handler returns as well.
+ * @note 5. Worst case latency of an event from outside is the longest handler
+ *          of lower priority, keep handlers short.
+ */
+class OSEventKernel
+{
+private:
+    OSTaskBase* m_pxHost = nullptr;
+    // Optional way to request dispatch instead of signalling the host Task,
+    // e.g. pending a software interrupt which calls @ref schedule()
+    void (*m_pxPendHook)(void) = nullptr;
+
+    os_event_dispatch_t m_pxDispatch[OS_EVENT_KERNEL_PRIORITIES];
+    void* m_pvTasks[OS_EVENT_KERNEL_PRIORITIES];
+
+    // Bit N - Task with priority N+1 has events
+    OSAtomic<uint32_t> m_uxReady;
+    // Priority of the handler being executed
+    volatile uint32_t m_uxCurrent = OS_EVENT_PRIORITY_IDLE;
+
+    OSCriticalSection m_xLock;
+
+    // Check if caller already runs on the kernel's stack
+    bool _isKernelContext(void)
+    {
+        return ((m_pxPendHook == nullptr) && (m_pxHost != nullptr) &&
+                (xTaskGetCurrentTaskHandle() == m_pxHost->getHandler()));
+    }
+
+public:
+    /**
+     * @param xHost Task which will call @ref runForever()
+     */
+    OSEventKernel(OSTaskBase& xHost) : m_pxHost(&xHost)
+    {
+        for (uint32_t i = 0u; i < OS_EVENT_KERNEL_PRIORITIES; i++) {
+            m_pxDispatch[i] = nullptr;
+            m_pvTasks[i] = nullptr;
+        }
+    };
+
+    /**
+     * @param pxPendHook Function requesting a call of @ref schedule(),
+     *                   usually pends a software interrupt
+     */
+    OSEventKernel(void (*pxPendHook)(void)) : m_pxPendHook(pxPendHook)
+    {
+        for (uint32_t i = 0u; i < OS_EVENT_KERNEL_PRIORITIES; i++) {
+            m_pxDispatch[i] = nullptr;
+            m_pvTasks[i] = nullptr;
+        }
+    };
+
+    /**
+     * @brief Register an event Task
+     *
+     * @param uxPriority Unique priority of the Task, 1..32
+     * @param pxDispatch Function handling one event of the Task
+     * @param pvTask Argument of pxDispatch
+     *
+     * @return "true" if successful, "false" if priority is wrong or taken
+     *
+     * @note Used by @ref OSEventTask, no need to call it directly
+     */
+    bool addTask(uint32_t uxPriority, os_event_dispatch_t pxDispatch, void* pvTask)
+    {
+        assert((uxPriority != OS_EVENT_PRIORITY_IDLE) && (uxPriority <= OS_EVENT_KERNEL_PRIORITIES));
+        if ((uxPriority == OS_EVENT_PRIORITY_IDLE) || (uxPriority > OS_EVENT_KERNEL_PRIORITIES)) {
+            return false;
+        }
+
+        assert(m_pxDispatch[uxPriority - 1u] == nullptr);
+        if (m_pxDispatch[uxPriority - 1u] != nullptr) {
+            return false;
+        }
+
+        m_pvTasks[uxPriority - 1u] = pvTask;
+        m_pxDispatch[uxPriority - 1u] = pxDispatch;
+        return true;
+    }
+
+    /**
+     * @brief Mark Task as ready and get it executed
+     *
+     * @param uxPriority Priority of the Task which got an event
+     *
+     * @note 1. This method is an ISR safe
+     * @note 2. Inside of a handler of the host Task higher priority Task
+     *          is executed right here, otherwise it waits for the current handler
+     */
+    OS_HOT_SECTION void activate(uint32_t uxPriority)
+    {
+        m_uxReady.fetchOr(1UL << (uxPriority - 1u));
+
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+            if (_isKernelContext()) {
+                // Synchronous preemption, it's just a function call
+                schedule();
+                return;
+            }
+        }
+
+        if (m_pxPendHook != nullptr) {
+            m_pxPendHook();
+        } else if (m_pxHost != nullptr) {
+            m_pxHost->emitSignal();
+        }
+    }
+
+    /**
+     * @brief Execute all ready Tasks with priority above the current one
+     *
+     * @note 1. Call it from the software interrupt if pend hook is used,
+     *          otherwise it's done by @ref runForever()
+     * @note 2. Nested calls are fine, that's how preemption works
+     */
+    OS_HOT_SECTION void schedule(void)
+    {
+        UBaseType_t uxStatus = m_xLock.enter();
+        const uint32_t uxPrevious = m_uxCurrent;
+
+        for (;;) {
+            uint32_t uxReady = m_uxReady.load();
+            if (uxReady == 0u) {
+                break;
+            }
+
+            uint32_t uxPriority = 32u - (uint32_t)__builtin_clz(uxReady);
+            if (uxPriority <= uxPrevious) {
+                break;
+            }
+
+            const uint32_t uxBit = 1UL << (uxPriority - 1u);
+            // Cleared before taking the event, so concurrent post always sets it again
+            m_uxReady.fetchAnd(~uxBit);
+            m_uxCurrent = uxPriority;
+            m_xLock.exit(uxStatus);
+
+            bool more = m_pxDispatch[uxPriority - 1u](m_pvTasks[uxPriority - 1u]);
+
+            uxStatus = m_xLock.enter();
+            if (more) {
+                m_uxReady.fetchOr(uxBit);
+            }
+        }
+
+        m_uxCurrent = uxPrevious;
+        m_xLock.exit(uxStatus);
+    }
+
+    /**
+     * @brief Endless loop of the host Task
+     *
+     * @note Must be called inside of host Task's code !
+     */
+    void runForever(void)
+    {
+        assert(m_pxHost != nullptr);
+
+        for (;;) {
+            schedule();
+            m_pxHost->waitSignal();
+        }
+    }
+
+    /**
+     * @brief Get priority of the handler being executed
+     *
+     * @retval OS_EVENT_PRIORITY_IDLE if none
+     */
+    uint32_t getCurrentPriority(void)
+    {
+        return m_uxCurrent;
+    }
+};
+
+
+/**
+ * @brief Run-to-completion event Task of @ref OSEventKernel
+ *
+ * @tparam Event Trivially copyable event type
+ * @tparam QueueSize Amount of queued events, power of two
+ */
+template <class Event, uint32_t QueueSize>
+class OSEventTask
+{
+private:
+    OSEventKernel& m_xKernel;
+    const uint32_t m_uxPriority;
+    void (*m_pxHandler)(const Event& xEvent);
+    // Priority may be wrong or taken, events must not go to another Task then
+    bool m_bRegistered = false;
+
+    OSLockFreeRing<Event, QueueSize> m_xEvents;
+
+    static bool _dispatch(void* pvTask)
+    {
+        OSEventTask* pxTask = static_cast<OSEventTask*>(pvTask);
+
+        Event xEvent;
+        if (!pxTask->m_xEvents.pop(xEvent)) {
+            return false;
+        }
+
+        pxTask->m_pxHandler(xEvent);
+        return !pxTask->m_xEvents.isEmpty();
+    }
+
+public:
+    /**
+     * @param xKernel Kernel which executes the Task
+     * @param uxPriority Unique priority of the Task, 1..32, the bigger the higher
+     * @param pxHandler Run-to-completion handler of the events
+     */
+    OSEventTask(OSEventKernel& xKernel, uint32_t uxPriority, void (*pxHandler)(const Event& xEvent))
+                                : m_xKernel(xKernel), m_uxPriority(uxPriority), m_pxHandler(pxHandler)
+    {
+        assert(pxHandler != nullptr);
+        m_bRegistered = m_xKernel.addTask(uxPriority, _dispatch, this);
+    };
+
+    /**
+     * @brief Queue an event for the Task
+     *
+     * @param xEvent Event to copy
+     *
+     * @return "true" if successful, "false" if queue is full or Task isn't registered
+     *
+     * @note 1. This method is an ISR safe
+     * @note 2. This method is thread-safe and multi-core safe
+     */
+    OS_HOT_INLINE bool post(const Event& xEvent)
+    {
+        assert(m_bRegistered);
+        if (!m_bRegistered || !m_xEvents.push(xEvent)) {
+            return false;
+        }
+
+        m_xKernel.activate(m_uxPriority);
+        return true;
+    }
+
+    /**
+     * @brief Get priority of the Task
+     */
+    uint32_t getPriority(void)
+    {
+        return m_uxPriority;
+    }
+
+    /**
+     * @brief Check if Task was registered in the kernel
+     *
+     * @return "false" if priority was wrong or taken by another Task
+     */
+    bool isValid(void) const
+    {
+        return m_bRegistered;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_EVENT_KERNEL_HPP
@@ -0,0 +1,300 @@
+/**
+ * @file rtos_helper_idle.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_IDLE_HPP
+#define _RTOS_HELPER_IDLE_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_ring.hpp"
+#include "rtos_helper_task.hpp"
+#include "rtos_helper_timestamp.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Time budget of a job if it's not specified on submit
+#ifndef OS_IDLE_JOB_DEFAULT_BUDGET_US
+#define OS_IDLE_JOB_DEFAULT_BUDGET_US 100u
+#endif // OS_IDLE_JOB_DEFAULT_BUDGET_US
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Background job
+ *
+ * @param pvArg Argument passed on submit
+ * @param uxDeadline OSTimestamp value when job must return,
+ *                   check it with @ref OSIdleExecutorBase::isExpired()
+ *
+ * @return "true" if job has more work and must be called again,
+ *         "false" if it's done
+ *
+ * @note Job must NOT block, it may be executed by the Idle Task!
+ */
+typedef bool (*os_idle_job_func_t)(void* pvArg, uint32_t uxDeadline);
+
+typedef struct {
+    os_idle_job_func_t pxFunc;
+    void* pvArg;
+    uint32_t uxBudgetUs;
+} os_idle_job_t;
+
+
+/**
+ * @brief Non-template part of @ref OSIdleExecutor
+ */
+class OSIdleExecutorBase
+{
+private:
+    // Shared worker Task, if jobs are not executed from Idle hook
+    OSTaskBase* volatile m_pxWorker = nullptr;
+
+protected:
+    OSAtomic<uint32_t> m_uxRunCount;
+    OSAtomic<uint32_t> m_uxOverrunCount;
+    OSAtomic<uint32_t> m_uxDroppedCount;
+
+    OSIdleExecutorBase() {};
+
+    // Wake up worker Task, if there is one
+    OS_HOT_SECTION void _notifyWorker(void)
+    {
+        OSTaskBase* pxWorker = m_pxWorker;
+        if (pxWorker != nullptr) {
+            pxWorker->emitSignal();
+        }
+    }
+
+    void _setWorker(OSTaskBase* pxWorker)
+    {
+        m_pxWorker = pxWorker;
+    }
+
+    // Account a finished job slice
+    void _accountRun(uint32_t uxStart, uint32_t uxBudget)
+    {
+        m_uxRunCount.fetchAdd(1u);
+        if ((OSTimestamp::now() - uxStart) > uxBudget) {
+            m_uxOverrunCount.fetchAdd(1u);
+        }
+    }
+
+    // Convert budget into OSTimestamp units
+    static uint32_t _budgetToTicks(uint32_t uxBudgetUs)
+    {
+        return (uint32_t)(((uint64_t)uxBudgetUs * OSTimestamp::getFrequency()) / 1000000ULL);
+    }
+
+public:
+    /**
+     * @brief Check if job must return
+     *
+     * @param uxDeadline Deadline passed to the job
+     */
+    static inline bool isExpired(uint32_t uxDeadline)
+    {
+        return ((int32_t)(OSTimestamp::now() - uxDeadline) >= 0);
+    }
+
+    /**
+     * @brief Get amount of executed job slices
+     */
+    uint32_t getRunCount(void)
+    {
+        return m_uxRunCount.load();
+    }
+
+    /**
+     * @brief Get amount of job slices which took longer than their budget
+     */
+    uint32_t getOverrunCount(void)
+    {
+        return m_uxOverrunCount.load();
+    }
+
+    /**
+     * @brief Get amount of jobs lost because queue was full
+     */
+    uint32_t getDroppedCount(void)
+    {
+        return m_uxDroppedCount.load();
+    }
+};
+
+
+/**
+ * @brief Executor of short background jobs in spare CPU time
+ *
+ * Jobs are executed either by the Idle Task (no extra stack at all),
+ * or by a single shared lowest priority worker Task,
+ * so they never delay any real Task.
+ * Every job gets a time budget and must return before it's expired,
+ * telling whether it needs to be called again.
+ *
+ * @code{cpp}
+ * OSIdleExecutor<8> Background;
+ *
+ * bool compactFlash(void* pvArg, uint32_t uxDeadline)
+ * {
+ *     while (!OSIdleExecutorBase::isExpired(uxDeadline)) {
+ *         if (!compactOnePage()) {
+ *             return false; // done
+ *         }
+ *     }
+ *     return true; // call me again
+ * }
+ *
+ * void vApplicationIdleHook(void)
+ * {
+ *     Background.runFromIdle();
+ * }
+ * ...
+ * Background.submit(compactFlash, nullptr, 200u);
+ * @endcode
+ *
+ * @tparam JobsCount Size of the lock-free submission queue, power of two
+ *
+ * @note 1. Requires configUSE_IDLE_HOOK (or esp_register_freertos_idle_hook() on ESP32),
+ *          otherwise use @ref runForever() in the worker Task.
+ * @note 2. Only one of Idle hook or worker Task should execute the jobs.
+ */
+template <uint32_t JobsCount>
+class OSIdleExecutor : public OSIdleExecutorBase
+{
+private:
+    OSLockFreeRing<os_idle_job_t, JobsCount> m_xJobs;
+
+public:
+    OSIdleExecutor() {};
+
+    /**
+     * @brief Queue a job
+     *
+     * @param pxFunc Job function, see @ref os_idle_job_func_t
+     * @param pvArg Argument of the job
+     * @param uxBudgetUs Time slice of a single job call in microseconds
+     *
+     * @return "true" if successful, "false" if queue is full
+     *
+     * @note 1. This method is an ISR safe
+     * @note 2. This method is thread-safe and multi-core safe
+     */
+    OS_HOT_INLINE bool submit(os_idle_job_func_t pxFunc, void* pvArg = nullptr,
+                              uint32_t uxBudgetUs = OS_IDLE_JOB_DEFAULT_BUDGET_US)
+    {
+        assert(pxFunc != nullptr);
+        if (pxFunc == nullptr) {
+            return false;
+        }
+
+        os_idle_job_t xJob = {pxFunc, pvArg, uxBudgetUs};
+        if (!m_xJobs.push(xJob)) {
+            m_uxDroppedCount.fetchAdd(1u);
+            return false;
+        }
+
+        _notifyWorker();
+        return true;
+    }
+
+    /**
+     * @brief Run one queued job for its time budget
+     *
+     * @return "true" if job was executed, "false" if queue is empty
+     *
+     * @note Unfinished job is queued again, behind the other jobs
+     */
+    bool runOnce(void)
+    {
+        os_idle_job_t xJob;
+        if (!m_xJobs.pop(xJob)) {
+            return false;
+        }
+
+        uint32_t uxBudget = _budgetToTicks(xJob.uxBudgetUs);
+        uint32_t uxStart = OSTimestamp::now();
+
+        bool more = xJob.pxFunc(xJob.pvArg, uxStart + uxBudget);
+        _accountRun(uxStart, uxBudget);
+
+        if (more && !m_xJobs.push(xJob)) {
+            m_uxDroppedCount.fetchAdd(1u);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run queued jobs from the Idle Task
+     *
+     * @note Call it from vApplicationIdleHook(), it executes one job per call,
+     *       so Idle Task still does it's own housekeeping between jobs.
+     */
+    void runFromIdle(void)
+    {
+        runOnce();
+    }
+
+    /**
+     * @brief Endless loop of the shared worker Task
+     *
+     * @param xWorker Task which executes this method, usually with tskIDLE_PRIORITY
+     *
+     * @note Worker sleeps while the queue is empty and wakes up on @ref submit()
+     */
+    void runForever(OSTaskBase& xWorker)
+    {
+        _setWorker(&xWorker);
+
+        for (;;) {
+            if (!runOnce()) {
+                xWorker.waitSignal();
+            }
+        }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_IDLE_HPP
@@ -0,0 +1,243 @@
+/**
+ * @file rtos_helper_isr_sim.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_ISR_SIM_HPP
+#define _RTOS_HELPER_ISR_SIM_HPP
+
+#ifdef _RTOS_HELPER_CORE_HPP
+#error "rtos_helper_isr_sim.hpp must be included before any other helper!"
+#endif
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Fake ISR context for host test builds
+ *
+ * Overrides @ref OS_HELPER_IS_INSIDE_ISR() and @ref OS_HELPER_YIELD_FROM_ISR(),
+ * so every "FromISR" branch of the helpers can run on the POSIX port.
+ * Two ways to inject an interrupt:
+ *  - @ref raise() runs handler synchronously from a Task, fully deterministic;
+ *  - @ref attach() + @ref tickHook() runs handler from the port tick signal,
+ *    which preempts Tasks at random points like a real interrupt does.
+ *
+ * @code{cpp}
+ * // Must be included before any other helper
+ * #include "helpers/rtos_helper_isr_sim.hpp"
+ * #include "FreeRTOS_helper.hpp"
+ *
+ * OSQueue<8, uint32_t> RxQueue;
+ *
+ * void fakeUartIsr(void* pvArg)
+ * {
+ *     RxQueue.send(0x55u); // goes through xQueueSendFromISR()
+ * }
+ *
+ * extern "C" void vApplicationTickHook(void)
+ * {
+ *     OSIsrSim::tickHook();
+ * }
+ * ...
+ * OSIsrSim::attach(fakeUartIsr, nullptr, 2u); // every 2nd tick
+ * OSIsrSim::raise(fakeUartIsr);              // or right now
+ * @endcode
+ *
+ * @note 1. Intended ONLY for the FreeRTOS POSIX port (see OS_HELPER_VANILLA_FREERTOS).
+ * @note 2. Handler MUST follow all ISR rules: no blocking and only ISR safe calls.
+ */
+class OSIsrSim
+{
+private:
+    struct State {
+        // Depth of fake ISR nesting, non zero means "inside ISR"
+        volatile UBaseType_t nesting = 0u;
+        // Set by helpers when woken Task has higher priority
+        volatile BaseType_t yieldPending = pdFALSE;
+        // Handler injected from the tick hook
+        void (*handler)(void*) = nullptr;
+        void* arg = nullptr;
+        uint32_t periodTicks = 0u;
+        uint32_t tickCount = 0u;
+        // Amount of handlers executed, usable for throughput calculation
+        volatile uint32_t raised = 0u;
+    };
+
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    static void enter()
+    {
+        state().nesting++;
+    }
+
+    // Returns "true" if context switch was requested by handler
+    static bool leave()
+    {
+        assert(state().nesting != 0u);
+        state().raised++;
+
+        if (--state().nesting != 0u) {
+            return false;
+        }
+
+        bool res = (state().yieldPending == pdTRUE);
+        state().yieldPending = pdFALSE;
+        return res;
+    }
+
+public:
+    /**
+     * @brief Get status of fake ISR context
+     *
+     * @return pdTRUE if handler is executed right now, pdFALSE if not
+     */
+    static BaseType_t isInside()
+    {
+        return (state().nesting != 0u) ? pdTRUE : pdFALSE;
+    }
+
+    /**
+     * @brief Store context switch request made by "FromISR" API
+     *
+     * @param xHigherPriorityStatus Status returned by "FromISR" API
+     */
+    static void requestYield(BaseType_t xHigherPriorityStatus)
+    {
+        if (xHigherPriorityStatus == pdTRUE) {
+            state().yieldPending = pdTRUE;
+        }
+    }
+
+    /**
+     * @brief Execute handler in fake ISR context right now
+     *
+     * @param isrFuncPtr Pointer to the handler
+     * @param pvArg Argument passed to the handler
+     *
+     * @note Must be called from a Task, interrupts are masked during handler
+     */
+    static void raise(void (*isrFuncPtr)(void*), void* pvArg = nullptr)
+    {
+        assert(isrFuncPtr);
+
+        portDISABLE_INTERRUPTS();
+        enter();
+        isrFuncPtr(pvArg);
+        bool needYield = leave();
+        portENABLE_INTERRUPTS();
+
+        // Same as real ISR exit: switch happens right after handler
+        if (needYield) {
+            taskYIELD();
+        }
+    }
+
+    /**
+     * @brief Attach handler to be called from @ref tickHook()
+     *
+     * @param isrFuncPtr Pointer to the handler, nullptr to detach
+     * @param pvArg Argument passed to the handler
+     * @param everyTicks How often to execute handler, in ticks
+     *
+     * @note Must be called before scheduler is started or from a critical section
+     */
+    static void attach(void (*isrFuncPtr)(void*), void* pvArg = nullptr, uint32_t everyTicks = 1u)
+    {
+        assert(everyTicks != 0u);
+
+        state().handler = isrFuncPtr;
+        state().arg = pvArg;
+        state().periodTicks = everyTicks;
+        state().tickCount = 0u;
+    }
+
+    /**
+     * @brief Must be called from vApplicationTickHook()
+     *
+     * @note 1. Requires configUSE_TICK_HOOK and configUSE_PREEMPTION to be 1
+     * @note 2. Context switch requested by handler happens on exit of tick ISR
+     */
+    static void tickHook()
+    {
+        if (state().handler == nullptr) {
+            return;
+        }
+
+        if (++state().tickCount < state().periodTicks) {
+            return;
+        }
+        state().tickCount = 0u;
+
+        enter();
+        state().handler(state().arg);
+        // No switch here, hook runs in the middle of xTaskIncrementTick().
+        // "FromISR" API which woke a higher priority Task has already set
+        // kernel's xYieldPending, tick ISR checks it right after this hook
+        // and does the switch itself.
+        (void)leave();
+    }
+
+    /**
+     * @brief Get amount of executed handlers
+     */
+    static uint32_t getRaisedCount()
+    {
+        return state().raised;
+    }
+};
+
+// Replaces defaults which host build environment might have set (see extras/posix/host_arduino.h)
+#undef OS_HELPER_IS_INSIDE_ISR
+#undef OS_HELPER_YIELD_FROM_ISR
+#define OS_HELPER_IS_INSIDE_ISR() OSIsrSim::isInside()
+#define OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus) OSIsrSim::requestYield(xHigherPriorityStatus)
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_ISR_SIM_HPP
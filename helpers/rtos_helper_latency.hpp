@@ -0,0 +1,372 @@
+/**
+ * @file rtos_helper_latency.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_LATENCY_HPP
+#define _RTOS_HELPER_LATENCY_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_task.hpp"
+#include "rtos_helper_timestamp.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Amount of Tasks which can be monitored at the same time
+#ifndef OS_LATENCY_MONITOR_MAX_TASKS
+#define OS_LATENCY_MONITOR_MAX_TASKS 8u
+#endif // OS_LATENCY_MONITOR_MAX_TASKS
+
+// Histogram bucket N counts latencies of [2^N, 2^(N+1)) OSTimestamp units,
+// bucket 0 also counts zero latency.
+#define OS_LATENCY_MONITOR_BUCKETS 32u
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Ready-to-running latency statistics of a single Task
+ *
+ * @note All values are in OSTimestamp units, use OSTimestamp::toNs()
+ */
+typedef struct {
+    uint32_t uxSamples;     // Amount of measured wake-ups
+    uint32_t uxMaxTicks;    // Worst latency
+    uint64_t ullTotalTicks; // Sum of latencies, for the average
+    uint32_t uxHistogram[OS_LATENCY_MONITOR_BUCKETS];
+} os_latency_stats_t;
+
+
+/**
+ * @brief Scheduling latency monitor
+ *
+ * Measures how long every attached Task waits between being moved
+ * to the Ready list and actually being switched in.
+ * High values point to long critical sections, ISRs or wrong priorities.
+ *
+ * Setup:
+ *  1. Include helpers/rtos_helper_latency_trace.h at the end of FreeRTOSConfig.h;
+ *  2. Define OS_LATENCY_MONITOR_IMPL in exactly one C++ file before include
+ *     of this header, it emits kernel hook functions.
+ *
+ * @code{cpp}
+ * #define OS_LATENCY_MONITOR_IMPL
+ * #include "helpers/rtos_helper_latency.hpp"
+ * ...
+ * ControlTask.init();
+ * OSLatencyMonitor::attach(ControlTask);
+ * ...
+ * os_latency_stats_t stats;
+ * if (OSLatencyMonitor::getStats(ControlTask.getHandler(), stats)) {
+ *     printf("max %llu ns\n", (unsigned long long)OSTimestamp::toNs(stats.uxMaxTicks));
+ * }
+ * @endcode
+ *
+ * @note 1. Hooks are executed by the kernel inside critical section,
+ *          so statistics snapshot is consistent only per field.
+ * @note 2. On multi-core MCU cycle counters of different cores are not synchronised,
+ *          so pin monitored Tasks to a single core for exact values.
+ * @note 3. Readying while scheduler is suspended is accounted from
+ *          the moment Task is moved from pending list.
+ * @note 4. Critical sections and ISRs which mask the tick delay readying itself,
+ *          so they are NOT visible here. Measured is the dispatch delay:
+ *          higher or equal priority Tasks and ISRs running after readying.
+ * @note 5. Deleted Task is detached automatically.
+ */
+class OSLatencyMonitor
+{
+private:
+    typedef struct {
+        TaskHandle_t xTask;
+        uint32_t uxReadyStamp;
+        bool pending;
+        os_latency_stats_t xStats;
+    } os_latency_slot_t;
+
+    // Zero initialised at compile time, so hooks don't need any guard
+    static os_latency_slot_t* _slots(void)
+    {
+        static os_latency_slot_t xSlots[OS_LATENCY_MONITOR_MAX_TASKS];
+        return xSlots;
+    }
+
+    OS_HOT_SECTION static os_latency_slot_t* _find(const void* pxTask)
+    {
+        os_latency_slot_t* pxSlots = _slots();
+        for (uint32_t i = 0u; i < OS_LATENCY_MONITOR_MAX_TASKS; i++) {
+            if ((pxTask != nullptr) && (pxSlots[i].xTask == pxTask)) {
+                return &pxSlots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Readying hook also fires for a Task which is already running,
+    // e.g. on priority inheritance or vTaskPrioritySet(), that's not a wake-up
+    OS_HOT_SECTION static bool _isRunning(const void* pxTask)
+    {
+        for (uint32_t i = 0u; i < (uint32_t)OS_MCU_CORES_COUNT; i++) {
+            if (OS_HELPER_GET_CURRENT_TASK(i) == pxTask) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    OS_HOT_SECTION static uint32_t _bucket(uint32_t uxTicks)
+    {
+        return (uxTicks == 0u) ? 0u : (31u - (uint32_t)__builtin_clz(uxTicks));
+    }
+
+public:
+    /**
+     * @brief Start monitoring of the Task
+     *
+     * @param xTask Handler of already created Task
+     *
+     * @return "true" if successful, "false" if there is no free slot
+     */
+    static bool attach(TaskHandle_t xTask)
+    {
+        assert(xTask != nullptr);
+        if (xTask == nullptr) {
+            return false;
+        }
+        if (_find(xTask) != nullptr) {
+            return true;
+        }
+
+        os_latency_slot_t* pxSlot = nullptr;
+        os_latency_slot_t* pxSlots = _slots();
+        for (uint32_t i = 0u; (pxSlot == nullptr) && (i < OS_LATENCY_MONITOR_MAX_TASKS); i++) {
+            if (pxSlots[i].xTask == nullptr) {
+                pxSlot = &pxSlots[i];
+            }
+        }
+        if (pxSlot == nullptr) {
+            return false;
+        }
+
+        pxSlot->pending = false;
+        pxSlot->xStats = os_latency_stats_t();
+        // Publish slot only when it's clean
+        __atomic_store_n(&pxSlot->xTask, xTask, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    /**
+     * @brief Start monitoring of the Task
+     *
+     * @param xTask Task after @ref OSTaskBase::init()
+     *
+     * @return "true" if successful, "false" if there is no free slot
+     */
+    static bool attach(OSTaskBase& xTask)
+    {
+        return attach(xTask.getHandler());
+    }
+
+    /**
+     * @brief Stop monitoring of the Task
+     *
+     * @param xTask Handler of the Task
+     *
+     * @return "true" if successful, "false" if Task was not attached
+     */
+    static bool detach(TaskHandle_t xTask)
+    {
+        os_latency_slot_t* pxSlot = _find(xTask);
+        if (pxSlot == nullptr) {
+            return false;
+        }
+
+        __atomic_store_n(&pxSlot->xTask, (TaskHandle_t)nullptr, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    /**
+     * @brief Get copy of statistics
+     *
+     * @param xTask Handler of the Task
+     * @param xStats Where to store the statistics
+     *
+     * @return "true" if successful, "false" if Task was not attached
+     */
+    static bool getStats(TaskHandle_t xTask, os_latency_stats_t& xStats)
+    {
+        os_latency_slot_t* pxSlot = _find(xTask);
+        if (pxSlot == nullptr) {
+            return false;
+        }
+
+        xStats = pxSlot->xStats;
+        return true;
+    }
+
+    /**
+     * @brief Clear statistics of the Task
+     *
+     * @param xTask Handler of the Task
+     *
+     * @return "true" if successful, "false" if Task was not attached
+     */
+    static bool reset(TaskHandle_t xTask)
+    {
+        os_latency_slot_t* pxSlot = _find(xTask);
+        if (pxSlot == nullptr) {
+            return false;
+        }
+
+        pxSlot->xStats = os_latency_stats_t();
+        return true;
+    }
+
+    /**
+     * @brief Get the lowest latency counted in histogram bucket
+     *
+     * @param uxBucket Bucket in range 0..OS_LATENCY_MONITOR_BUCKETS
+     *
+     * @retval Latency in nanoseconds, top buckets don't fit in 32 bits at 240MHz
+     */
+    static uint64_t getBucketNs(uint32_t uxBucket)
+    {
+        assert(uxBucket < OS_LATENCY_MONITOR_BUCKETS);
+        return (uxBucket == 0u) ? 0u : OSTimestamp::toNs(1UL << uxBucket);
+    }
+
+    /**
+     * @brief Kernel hook, Task was moved to the Ready list
+     *
+     * @note 1. Called by traceMOVED_TASK_TO_READY_STATE(), not for the user
+     * @note 2. Only Blocked/Suspended -> Ready is a wake-up,
+     *          re-insertion of the running Task is ignored.
+     */
+    OS_HOT_SECTION static void onReady(void* pxTCB)
+    {
+        os_latency_slot_t* pxSlot = _find(pxTCB);
+        if ((pxSlot != nullptr) && !pxSlot->pending && !_isRunning(pxTCB)) {
+            pxSlot->uxReadyStamp = OSTimestamp::now();
+            pxSlot->pending = true;
+        }
+    }
+
+    /**
+     * @brief Kernel hook, Task is suspended
+     *
+     * @note 1. Called by traceTASK_SUSPEND(), not for the user
+     * @note 2. Ready Task may be suspended before it runs, then that wake-up
+     *          is dropped, otherwise the next real one would be skipped.
+     */
+    OS_HOT_SECTION static void onSuspended(void* pxTCB)
+    {
+        os_latency_slot_t* pxSlot = _find(pxTCB);
+        if (pxSlot != nullptr) {
+            pxSlot->pending = false;
+        }
+    }
+
+    /**
+     * @brief Kernel hook, Task is deleted
+     *
+     * @note Called by traceTASK_DELETE(), not for the user.
+     *       Slot is freed, a new Task may get the same TCB address.
+     */
+    OS_HOT_SECTION static void onDeleted(void* pxTCB)
+    {
+        os_latency_slot_t* pxSlot = _find(pxTCB);
+        if (pxSlot != nullptr) {
+            pxSlot->pending = false;
+            __atomic_store_n(&pxSlot->xTask, (TaskHandle_t)nullptr, __ATOMIC_SEQ_CST);
+        }
+    }
+
+    /**
+     * @brief Kernel hook, Task was switched in
+     *
+     * @note Called by traceTASK_SWITCHED_IN(), not for the user
+     */
+    OS_HOT_SECTION static void onSwitchedIn(void)
+    {
+        os_latency_slot_t* pxSlot = _find(xTaskGetCurrentTaskHandle());
+        if ((pxSlot == nullptr) || !pxSlot->pending) {
+            return;
+        }
+
+        uint32_t uxTicks = OSTimestamp::now() - pxSlot->uxReadyStamp;
+        pxSlot->pending = false;
+
+        os_latency_stats_t& xStats = pxSlot->xStats;
+        xStats.uxSamples++;
+        xStats.ullTotalTicks += uxTicks;
+        if (uxTicks > xStats.uxMaxTicks) {
+            xStats.uxMaxTicks = uxTicks;
+        }
+        xStats.uxHistogram[_bucket(uxTicks)]++;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifdef OS_LATENCY_MONITOR_IMPL
+// Kernel hooks, see rtos_helper_latency_trace.h
+extern "C" OS_HOT_SECTION void osLatencyMonitorReady(void* pxTCB)
+{
+    OSLatencyMonitor::onReady(pxTCB);
+}
+
+extern "C" OS_HOT_SECTION void osLatencyMonitorSwitchedIn(void)
+{
+    OSLatencyMonitor::onSwitchedIn();
+}
+
+extern "C" OS_HOT_SECTION void osLatencyMonitorSuspended(void* pxTCB)
+{
+    OSLatencyMonitor::onSuspended(pxTCB);
+}
+
+extern "C" OS_HOT_SECTION void osLatencyMonitorDeleted(void* pxTCB)
+{
+    OSLatencyMonitor::onDeleted(pxTCB);
+}
+#endif // OS_LATENCY_MONITOR_IMPL
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_LATENCY_HPP
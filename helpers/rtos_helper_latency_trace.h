@@ -0,0 +1,51 @@
+/**
+ * @file rtos_helper_latency_trace.h
+ *
+ * Kernel trace hooks of the scheduling latency monitor.
+ * Include it at the very end of FreeRTOSConfig.h:
+ *
+ *   #include "helpers/rtos_helper_latency_trace.h"
+ *
+ * and define OS_LATENCY_MONITOR_IMPL in exactly one C++ file
+ * before including rtos_helper_latency.hpp.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_LATENCY_TRACE_H
+#define _RTOS_HELPER_LATENCY_TRACE_H
+
+// FreeRTOSConfig.h is also included from port assembler files
+#ifndef __ASSEMBLER__
+
+#if defined(traceMOVED_TASK_TO_READY_STATE) || defined(traceTASK_SWITCHED_IN) || \
+    defined(traceTASK_SUSPEND) || defined(traceTASK_DELETE)
+#error "Kernel trace hooks are already defined, latency monitor can't be attached!"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Implemented by rtos_helper_latency.hpp with OS_LATENCY_MONITOR_IMPL
+void osLatencyMonitorReady(void* pxTCB);
+void osLatencyMonitorSwitchedIn(void);
+void osLatencyMonitorSuspended(void* pxTCB);
+void osLatencyMonitorDeleted(void* pxTCB);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB) osLatencyMonitorReady((void*)(pxTCB))
+#define traceTASK_SWITCHED_IN() osLatencyMonitorSwitchedIn()
+#define traceTASK_SUSPEND(pxTCB) osLatencyMonitorSuspended((void*)(pxTCB))
+#define traceTASK_DELETE(pxTCB) osLatencyMonitorDeleted((void*)(pxTCB))
+
+#endif // __ASSEMBLER__
+
+#endif // _RTOS_HELPER_LATENCY_TRACE_H
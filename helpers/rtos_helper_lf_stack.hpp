@@ -0,0 +1,255 @@
+/**
+ * @file rtos_helper_lf_stack.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_LF_STACK_HPP
+#define _RTOS_HELPER_LF_STACK_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Returned by pop of an empty stack
+#define OS_LOCK_FREE_STACK_EMPTY 0xFFFFFFFFUL
+
+// Max amount of nodes, index must fit into the lower half of the head
+#define OS_LOCK_FREE_STACK_MAX 0xFFFEUL
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Untyped Treiber stack of node indexes
+ *
+ * Head is a single 32-bit word: tag in the upper half and index + 1
+ * in the lower one, so one 32-bit CAS of @ref OSAtomic updates it.
+ * That's a native instruction where OSAtomic is native (Xtensa, RISC-V
+ * with "A" extension, Cortex-M3 and newer, host), on other cores
+ * (Cortex-M0+ of RP2040, ESP32-S2 ...) it's a short critical section.
+ * Tag is changed by every push and pop, that's what protects from ABA:
+ * CAS fails if the node was popped and pushed back meanwhile.
+ *
+ * Links are kept in a separate array, not inside of the nodes,
+ * so a node is free to be overwritten as soon as it's popped.
+ *
+ * @note 1. This class is thread-safe, multi-core safe and an ISR safe
+ * @note 2. Tag has 16 bits, ABA is still possible if a single push or pop
+ *          is preempted for exactly 65536 operations of others.
+ * @note 3. Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSLockFreeStackBase
+{
+private:
+    OSAtomic<uint32_t>* m_pxNext = nullptr;
+    uint32_t m_uxCapacity = 0u;
+
+    OSAtomic<uint32_t> m_uxHead;
+
+public:
+    /**
+     * @param pxNext Storage of links, one per node
+     * @param uxCapacity Amount of nodes, not more than OS_LOCK_FREE_STACK_MAX
+     */
+    OSLockFreeStackBase(OSAtomic<uint32_t>* pxNext, uint32_t uxCapacity)
+                                : m_pxNext(pxNext), m_uxCapacity(uxCapacity)
+    {
+        assert(uxCapacity <= OS_LOCK_FREE_STACK_MAX);
+    };
+
+    /**
+     * @brief Put a node on top
+     *
+     * @param uxIndex Index of the node, must not be in the stack already
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION void pushIndex(uint32_t uxIndex)
+    {
+        assert(uxIndex < m_uxCapacity);
+
+        uint32_t uxHead = m_uxHead.load();
+        for (;;) {
+            m_pxNext[uxIndex].store(uxHead & 0xFFFFu);
+
+            uint32_t uxNew = ((uxHead + 0x10000u) & 0xFFFF0000u) | (uxIndex + 1u);
+            if (m_uxHead.compareExchange(uxHead, uxNew)) {
+                return;
+            }
+            // uxHead is reloaded by failed CAS
+        }
+    }
+
+    /**
+     * @brief Take the node from top
+     *
+     * @retval Index of the node, OS_LOCK_FREE_STACK_EMPTY if stack is empty
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_SECTION uint32_t popIndex(void)
+    {
+        uint32_t uxHead = m_uxHead.load();
+        for (;;) {
+            uint32_t uxTop = uxHead & 0xFFFFu;
+            if (uxTop == 0u) {
+                return OS_LOCK_FREE_STACK_EMPTY;
+            }
+
+            // Might be stale if the node is taken meanwhile, then tag makes CAS fail
+            uint32_t uxNext = m_pxNext[uxTop - 1u].load();
+            uint32_t uxNew = ((uxHead + 0x10000u) & 0xFFFF0000u) | uxNext;
+            if (m_uxHead.compareExchange(uxHead, uxNew)) {
+                return uxTop - 1u;
+            }
+        }
+    }
+
+    /**
+     * @brief Check if there is no nodes
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    bool isEmpty(void)
+    {
+        return ((m_uxHead.load() & 0xFFFFu) == 0u);
+    }
+
+    /**
+     * @brief Get amount of nodes it can hold
+     */
+    uint32_t getCapacity(void)
+    {
+        return m_uxCapacity;
+    }
+};
+
+
+/**
+ * @brief Lock-free LIFO of nodes from a fixed array, e.g. a free list
+ *
+ * @code{cpp}
+ * Message messages[16];
+ * OSLockFreeStack<Message, 16> freeMessages(messages);
+ * ...
+ * freeMessages.fill(); // all nodes are free at start
+ * ...
+ * // In any ISR, Task or core:
+ * Message* msg = freeMessages.pop();
+ * if (msg != nullptr) {
+ *     ...
+ *     freeMessages.push(msg);
+ * }
+ * @endcode
+ *
+ * @tparam Node Type of the nodes
+ * @tparam Capacity Amount of nodes in the array
+ *
+ * @note 1. This class is thread-safe, multi-core safe and an ISR safe
+ * @note 2. No critical section is taken only if OSAtomic<uint32_t>::isNative(),
+ *          e.g. on RP2040 every push and pop masks interrupts for a single CAS
+ */
+template <class Node, uint32_t Capacity>
+class OSLockFreeStack : public OSLockFreeStackBase
+{
+    static_assert((Capacity != 0u) && (Capacity <= OS_LOCK_FREE_STACK_MAX),
+                  "Capacity must be 1..OS_LOCK_FREE_STACK_MAX");
+
+private:
+    Node* m_pxNodes = nullptr;
+    OSAtomic<uint32_t> m_uxNext[Capacity];
+
+public:
+    /**
+     * @param pxNodes Array of Capacity nodes, stack starts empty
+     */
+    OSLockFreeStack(Node* pxNodes) : OSLockFreeStackBase(m_uxNext, Capacity), m_pxNodes(pxNodes) {};
+
+    /**
+     * @brief Push every node of the array
+     *
+     * @note Call it once before the stack is used, so first pop() returns the first node
+     */
+    void fill(void)
+    {
+        for (uint32_t i = Capacity; i > 0u; i--) {
+            pushIndex(i - 1u);
+        }
+    }
+
+    /**
+     * @brief Put a node on top
+     *
+     * @param pxNode Node of the array, must not be in the stack already
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE void push(Node* pxNode)
+    {
+        pushIndex(getIndex(pxNode));
+    }
+
+    /**
+     * @brief Take the node from top
+     *
+     * @retval Node, nullptr if stack is empty
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE Node* pop(void)
+    {
+        uint32_t uxIndex = popIndex();
+        return (uxIndex == OS_LOCK_FREE_STACK_EMPTY) ? nullptr : &m_pxNodes[uxIndex];
+    }
+
+    /**
+     * @brief Get index of the node in the array
+     */
+    uint32_t getIndex(const Node* pxNode)
+    {
+        assert((pxNode >= m_pxNodes) && (pxNode < &m_pxNodes[Capacity]));
+        return (uint32_t)(pxNode - m_pxNodes);
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_LF_STACK_HPP
@@ -0,0 +1,380 @@
+/**
+ * @file rtos_helper_map.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_MAP_HPP
+#define _RTOS_HELPER_MAP_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "semphr.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/semphr.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include <type_traits>
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_mutex.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// State of a bucket
+typedef enum {
+  OS_MAP_BUCKET_EMPTY = 0UL, // Never used, ends the probe
+  OS_MAP_BUCKET_FULL,        // Holds a key
+  OS_MAP_BUCKET_DELETED      // Key was removed, probe goes on
+} os_map_bucket_state_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Default hash of @ref OSConcurrentMap, FNV-1a over bytes of the key
+ *
+ * @note Key must have no padding, or provide your own hash
+ */
+template <class K>
+struct OSMapHash
+{
+    uint32_t operator()(const K& xKey) const
+    {
+        const uint8_t* pucKey = reinterpret_cast<const uint8_t*>(&xKey);
+        uint32_t uxHash = 2166136261UL;
+
+        for (size_t i = 0u; i < sizeof(K); i++) {
+            uxHash = (uxHash ^ pucKey[i]) * 16777619UL;
+        }
+        return uxHash;
+    }
+};
+
+
+#if (configUSE_MUTEXES == 1)
+/**
+ * @brief Fixed-capacity hash map for read-mostly tables
+ *
+ * Open addressing with linear probing. Every bucket holds two copies
+ * of its entry and a sequence counter: writer updates one copy while
+ * readers are pointed to the other one, so lookup never waits for a writer,
+ * even for the one it has preempted. Lookup is retried only if an update
+ * of the same bucket has completed meanwhile.
+ * Writers are serialised by an OSMutex and never block lookups.
+ *
+ * @code{cpp}
+ * OSConcurrentMap<uint32_t, Route, 64> Routes;
+ * ...
+ * Routes.init();
+ * Routes.insert(dstAddr, route);
+ * ...
+ * // Any Task, core or ISR:
+ * Route route;
+ * if (Routes.find(dstAddr, route)) {
+ *     forward(packet, route);
+ * }
+ * @endcode
+ *
+ * @tparam K Trivially copyable key with operator==
+ * @tparam V Trivially copyable value
+ * @tparam N Amount of buckets, power of two
+ * @tparam Hash Callable returning uint32_t hash of a key
+ *
+ * @note 1. find() and contains() are an ISR safe, the rest is NOT.
+ * @note 2. Removed keys leave tombstones, they are reused by insert()
+ *          but make misses longer until clear().
+ * @note 3. Memory is 2 * N entries, that's the price of non-waiting lookups.
+ */
+template <class K, class V, uint32_t N, class Hash = OSMapHash<K>>
+class OSConcurrentMap
+{
+    static_assert((N != 0u) && ((N & (N - 1u)) == 0u), "N must be power of two");
+    static_assert(std::is_trivially_copyable<K>::value, "K must be trivially copyable");
+    static_assert(std::is_trivially_copyable<V>::value, "V must be trivially copyable");
+
+private:
+    typedef struct {
+        uint32_t uxState;
+        K xKey;
+        V xValue;
+    } os_map_entry_t;
+
+    typedef struct {
+        // Even - readers take copy 0, odd - copy 1
+        OSAtomic<uint32_t> uxSeq;
+        os_map_entry_t xCopy[2];
+    } os_map_bucket_t;
+
+    os_map_bucket_t m_xBuckets[N];
+    uint32_t m_uxCount = 0u;
+
+    OSMutex m_xWriters;
+
+    static uint32_t _index(const K& xKey)
+    {
+        return Hash()(xKey) & (N - 1u);
+    }
+
+    // Consistent snapshot of the bucket, safe against any writer
+    OS_HOT_INLINE void _read(uint32_t uxIndex, os_map_entry_t& xEntry) const
+    {
+        const os_map_bucket_t& xBucket = m_xBuckets[uxIndex];
+
+        for (;;) {
+            uint32_t uxSeq = xBucket.uxSeq.load();
+            memcpy(&xEntry, &xBucket.xCopy[uxSeq & 1u], sizeof(os_map_entry_t));
+
+            // Copy must be done before the sequence is checked again
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (xBucket.uxSeq.load() == uxSeq) {
+                return;
+            }
+        }
+    }
+
+    // Must be called with m_xWriters taken
+    void _write(uint32_t uxIndex, const os_map_entry_t& xEntry)
+    {
+        os_map_bucket_t& xBucket = m_xBuckets[uxIndex];
+
+        // Readers go to copy 1 while copy 0 is changed, then back
+        xBucket.uxSeq.fetchAdd(1u);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&xBucket.xCopy[0], &xEntry, sizeof(os_map_entry_t));
+
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        xBucket.uxSeq.fetchAdd(1u);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&xBucket.xCopy[1], &xEntry, sizeof(os_map_entry_t));
+    }
+
+    // Must be called with m_xWriters taken, both copies are equal then
+    uint32_t _getState(uint32_t uxIndex)
+    {
+        return m_xBuckets[uxIndex].xCopy[0].uxState;
+    }
+
+    // Must be called with m_xWriters taken
+    uint32_t _findLocked(const K& xKey)
+    {
+        uint32_t uxIndex = _index(xKey);
+
+        for (uint32_t i = 0u; i < N; i++) {
+            const os_map_entry_t& xEntry = m_xBuckets[uxIndex].xCopy[0];
+            if (xEntry.uxState == OS_MAP_BUCKET_EMPTY) {
+                break;
+            }
+            if ((xEntry.uxState == OS_MAP_BUCKET_FULL) && (xEntry.xKey == xKey)) {
+                return uxIndex;
+            }
+            uxIndex = (uxIndex + 1u) & (N - 1u);
+        }
+        return N;
+    }
+
+public:
+    OSConcurrentMap()
+    {
+        for (uint32_t i = 0u; i < N; i++) {
+            m_xBuckets[i].xCopy[0].uxState = OS_MAP_BUCKET_EMPTY;
+            m_xBuckets[i].xCopy[1].uxState = OS_MAP_BUCKET_EMPTY;
+        }
+    };
+
+    /**
+     * @brief Create Mutex of the writers
+     *
+     * @return "true" if successful, "false" if not initialised
+     */
+    bool init(void)
+    {
+        return m_xWriters.init();
+    }
+
+    /**
+     * @brief Add a key or replace its value
+     *
+     * @param xKey Key
+     * @param xValue Value
+     *
+     * @return "true" if successful, "false" if map is full
+     *
+     * @note Concurrent lookup returns either old or new value, never a mix
+     */
+    bool insert(const K& xKey, const V& xValue)
+    {
+        os_map_entry_t xEntry;
+        xEntry.uxState = OS_MAP_BUCKET_FULL;
+        xEntry.xKey = xKey;
+        xEntry.xValue = xValue;
+
+        m_xWriters.lock();
+
+        uint32_t uxIndex = _findLocked(xKey);
+        if (uxIndex == N) {
+            // First reusable bucket of the probe
+            uxIndex = _index(xKey);
+            uint32_t i = 0u;
+            for (; i < N; i++) {
+                if (_getState(uxIndex) != OS_MAP_BUCKET_FULL) {
+                    break;
+                }
+                uxIndex = (uxIndex + 1u) & (N - 1u);
+            }
+
+            if (i == N) {
+                m_xWriters.unlock();
+                return false;
+            }
+            m_uxCount++;
+        }
+
+        _write(uxIndex, xEntry);
+        m_xWriters.unlock();
+        return true;
+    }
+
+    /**
+     * @brief Remove a key
+     *
+     * @param xKey Key
+     *
+     * @return "true" if key was removed, "false" if there was no such key
+     */
+    bool remove(const K& xKey)
+    {
+        m_xWriters.lock();
+
+        uint32_t uxIndex = _findLocked(xKey);
+        if (uxIndex == N) {
+            m_xWriters.unlock();
+            return false;
+        }
+
+        os_map_entry_t xEntry = m_xBuckets[uxIndex].xCopy[0];
+        xEntry.uxState = OS_MAP_BUCKET_DELETED;
+        _write(uxIndex, xEntry);
+        m_uxCount--;
+
+        m_xWriters.unlock();
+        return true;
+    }
+
+    /**
+     * @brief Remove all keys and tombstones
+     */
+    void clear(void)
+    {
+        os_map_entry_t xEntry;
+        memset(&xEntry, 0, sizeof(xEntry));
+        xEntry.uxState = OS_MAP_BUCKET_EMPTY;
+
+        m_xWriters.lock();
+        for (uint32_t i = 0u; i < N; i++) {
+            if (_getState(i) != OS_MAP_BUCKET_EMPTY) {
+                _write(i, xEntry);
+            }
+        }
+        m_uxCount = 0u;
+        m_xWriters.unlock();
+    }
+
+    /**
+     * @brief Look up a key
+     *
+     * @param xKey Key
+     * @param xValue Where to copy the value
+     *
+     * @return "true" if found, "false" if there is no such key
+     *
+     * @note 1. This method is an ISR safe, it never takes a lock
+     * @note 2. This method is thread-safe and multi-core safe
+     */
+    OS_HOT_INLINE bool find(const K& xKey, V& xValue) const
+    {
+        uint32_t uxIndex = _index(xKey);
+        os_map_entry_t xEntry;
+
+        for (uint32_t i = 0u; i < N; i++) {
+            _read(uxIndex, xEntry);
+
+            if (xEntry.uxState == OS_MAP_BUCKET_EMPTY) {
+                return false;
+            }
+            if ((xEntry.uxState == OS_MAP_BUCKET_FULL) && (xEntry.xKey == xKey)) {
+                xValue = xEntry.xValue;
+                return true;
+            }
+            uxIndex = (uxIndex + 1u) & (N - 1u);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Check if there is a key
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE bool contains(const K& xKey) const
+    {
+        V xValue;
+        return find(xKey, xValue);
+    }
+
+    /**
+     * @brief Get amount of keys
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getCount(void)
+    {
+        return m_uxCount;
+    }
+
+    /**
+     * @brief Get amount of buckets
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return N;
+    }
+};
+#endif // configUSE_MUTEXES
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_MAP_HPP
@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "semphr.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -102,7 +105,7 @@ public:
             m_initialized = true;
         }
 
-        return (m_MutexHandler == nullptr);
+        return m_initialized;
     }
 
     /**
@@ -139,6 +142,8 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
         bool res = (bool)xSemaphoreTake(m_MutexHandler, pdMS_TO_TICKS(xMsToWait));
 
         return res;
@@ -163,6 +168,8 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
         bool res = (bool)xSemaphoreGive(m_MutexHandler);
 
         return res;
@@ -0,0 +1,487 @@
+/**
+ * @file rtos_helper_profiler.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_PROFILER_HPP
+#define _RTOS_HELPER_PROFILER_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Program counter of the Task interrupted by the tick, 0 if unknown.
+// It's read from the frame saved on the Task stack at interrupt entry:
+//  - Cortex-M (M0+ too): hardware stacked frame at PSP;
+//  - ESP32 Xtensa and RISC-V: port's frame at pxTopOfStack of the running Task.
+// Other ports have no sampling (OS_PROFILER_NO_PC), define it before include for them.
+#ifndef OS_PROFILER_GET_PC
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+#define OS_PROFILER_PC_FROM_PSP
+#define OS_PROFILER_GET_PC() _osProfilerGetPc()
+#elif (defined(ESP32) || defined(ESP_PLATFORM)) && (defined(__XTENSA__) || defined(__riscv))
+#define OS_PROFILER_PC_FROM_TCB
+#define OS_PROFILER_GET_PC() _osProfilerGetPc()
+#else
+#define OS_PROFILER_NO_PC
+#define OS_PROFILER_GET_PC() ((uintptr_t)0u)
+#endif
+#endif // OS_PROFILER_GET_PC
+
+// Core which executes the tick hook right now
+#ifndef OS_PROFILER_CORE_ID
+#if (defined(ESP32) || defined(ESP_PLATFORM))
+#define OS_PROFILER_CORE_ID() ((uint32_t)xPortGetCoreID())
+#elif (OS_MCU_CORES_COUNT > 1)
+#define OS_PROFILER_CORE_ID() ((uint32_t)portGET_CORE_ID())
+#else
+#define OS_PROFILER_CORE_ID() (0u)
+#endif
+#endif // OS_PROFILER_CORE_ID
+
+// Task currently running on the given core
+#ifndef OS_PROFILER_GET_TASK
+#define OS_PROFILER_GET_TASK(core) OS_HELPER_GET_CURRENT_TASK(core)
+#endif // OS_PROFILER_GET_TASK
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+#if defined(OS_PROFILER_PC_FROM_PSP)
+// Tasks run on PSP, so exception entry has stacked
+// r0-r3, r12, lr, pc, xpsr right there, PC is the 7th word.
+// ISRs preempted by the tick run on MSP, their time goes to the Task they interrupted.
+OS_HOT_INLINE static inline uintptr_t _osProfilerGetPc(void)
+{
+    uint32_t* puxFrame = nullptr;
+    __asm__ __volatile__("mrs %0, psp" : "=r"(puxFrame));
+    return (uintptr_t)puxFrame[6];
+}
+#elif defined(OS_PROFILER_PC_FROM_TCB)
+// Interrupt entry of ESP-IDF port saves frame of the interrupted Task on it's stack
+// and stores SP into pxTopOfStack, which is the first member of TCB.
+// Xtensa XtExcFrame starts with exit, pc; RISC-V RvExcFrame starts with mepc.
+OS_HOT_INLINE static inline uintptr_t _osProfilerGetPc(void)
+{
+    uint32_t* puxFrame = *reinterpret_cast<uint32_t**>(xTaskGetCurrentTaskHandle());
+#if defined(__XTENSA__)
+    return (uintptr_t)puxFrame[1];
+#else
+    return (uintptr_t)puxFrame[0];
+#endif
+}
+#endif // OS_PROFILER_PC_FROM_PSP
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/**
+ * @brief Single sample taken by the tick hook
+ */
+typedef struct {
+    TaskHandle_t xTask; // Task running on the core
+    uintptr_t uxPc;     // Interrupted PC, 0 if unknown
+    uint32_t uxCore;    // Core number
+} os_profiler_sample_t;
+
+
+/**
+ * @brief Sampling part of @ref OSProfiler, called from the tick ISR
+ *
+ * @note Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSProfilerBase
+{
+private:
+    // Ring of samples, written only from the tick hook
+    os_profiler_sample_t* m_pxSamples = nullptr;
+    uint32_t m_uxMask = 0u;
+    OSAtomic<uint32_t> m_uxHead;
+    OSAtomic<uint32_t> m_uxTail;
+
+    // Take sample only every Nth tick
+    uint32_t m_uxDivider = 1u;
+    uint32_t m_uxTicks = 0u;
+
+    // Samples lost as ring was full
+    OSAtomic<uint32_t> m_uxDropped;
+
+    volatile bool m_enabled = false;
+
+protected:
+    // Only @ref OSProfiler is allowed to create it, as it holds the storage
+    OSProfilerBase(os_profiler_sample_t* pxSamples, uint32_t uxSamplesCount)
+                                : m_pxSamples(pxSamples), m_uxMask(uxSamplesCount - 1u) {};
+
+    /**
+     * @brief Get next sample from the ring
+     *
+     * @param xSample Where to store the sample
+     *
+     * @return "true" if sample was taken, "false" if ring is empty
+     */
+    bool _pop(os_profiler_sample_t& xSample)
+    {
+        uint32_t uxTail = m_uxTail.load();
+        if (uxTail == m_uxHead.load()) {
+            return false;
+        }
+
+        xSample = m_pxSamples[uxTail & m_uxMask];
+        m_uxTail.store(uxTail + 1u);
+        return true;
+    }
+
+public:
+    /**
+     * @brief Sample running Tasks, must be called from vApplicationTickHook()
+     *
+     * @note 1. This method is an ISR safe
+     * @note 2. On multi-core MCU only the call on core 0 takes samples,
+     *          for Tasks of all cores at once.
+     */
+    OS_HOT_SECTION void tickHook(void)
+    {
+        if (!m_enabled) {
+            return;
+        }
+
+        uint32_t uxCore = OS_PROFILER_CORE_ID();
+        if (uxCore != 0u) {
+            return;
+        }
+
+        if (++m_uxTicks < m_uxDivider) {
+            return;
+        }
+        m_uxTicks = 0u;
+
+        uint32_t uxHead = m_uxHead.load();
+
+        for (uint32_t i = 0u; i < (uint32_t)OS_MCU_CORES_COUNT; i++) {
+            if ((uxHead - m_uxTail.load()) > m_uxMask) {
+                m_uxDropped.fetchAdd(1u);
+                continue;
+            }
+
+            os_profiler_sample_t& xSample = m_pxSamples[uxHead & m_uxMask];
+            xSample.xTask = OS_PROFILER_GET_TASK(i);
+            xSample.uxPc = (i == uxCore) ? OS_PROFILER_GET_PC() : (uintptr_t)0u;
+            xSample.uxCore = i;
+            uxHead++;
+        }
+
+        // Publish all samples of this tick at once
+        m_uxHead.store(uxHead);
+    }
+
+    /**
+     * @brief Take sample only every Nth tick
+     *
+     * @param uxDivider Amount of ticks between samples, 1 - every tick
+     */
+    void setDivider(uint32_t uxDivider)
+    {
+        assert(uxDivider != 0u);
+        m_uxDivider = (uxDivider != 0u) ? uxDivider : 1u;
+    }
+
+    /**
+     * @brief Start taking samples
+     */
+    void start(void)
+    {
+        m_enabled = true;
+    }
+
+    /**
+     * @brief Stop taking samples, already taken are kept
+     */
+    void stop(void)
+    {
+        m_enabled = false;
+    }
+
+    /**
+     * @brief Get amount of samples lost because ring was full
+     *
+     * @note Means that @ref aggregate() is called too rarely
+     */
+    uint32_t getDroppedCount(void)
+    {
+        return m_uxDropped.load();
+    }
+};
+
+
+/**
+ * @brief Statistical profiler driven by the tick hook
+ *
+ * Tick hook only puts running Task (and optionally interrupted PC)
+ * into lock-free ring. Reporting Task periodically calls @ref aggregate()
+ * to fold samples into per-Task and per-address histograms.
+ *
+ * @code{cpp}
+ * OSProfiler<256> Profiler;
+ *
+ * void vApplicationTickHook(void)
+ * {
+ *     Profiler.tickHook();
+ * }
+ * ...
+ * Profiler.setDivider(4u); // sample every 4th tick
+ * Profiler.start();
+ * ...
+ * // Meanwhile in reporting Task:
+ * Profiler.aggregate();
+ * for (uint32_t i = 0u; i < Profiler.getTasksCount(); i++) {
+ *     printf("%s %u\n", pcTaskGetName(Profiler.getTask(i)), Profiler.getTaskSamples(i));
+ * }
+ * @endcode
+ *
+ * @tparam SamplesCount Size of the ring, must be power of two
+ * @tparam MaxTasks Amount of different Tasks tracked, rest is counted as "other"
+ * @tparam PcBuckets Amount of address ranges in PC histogram, see @ref setPcRange()
+ *
+ * @note 1. Requires configUSE_TICK_HOOK (or esp_register_freertos_tick_hook() on ESP32)
+ * @note 2. Only single Task may call @ref aggregate()
+ * @note 3. PC histogram is filled on Cortex-M and ESP32 only (see OS_PROFILER_GET_PC()),
+ *          and only for the core which executes the tick hook.
+ */
+template <uint32_t SamplesCount, uint32_t MaxTasks = 16u, uint32_t PcBuckets = 64u>
+class OSProfiler : public OSProfilerBase
+{
+    static_assert((SamplesCount != 0u) && ((SamplesCount & (SamplesCount - 1u)) == 0u),
+                  "SamplesCount must be power of two");
+
+private:
+    os_profiler_sample_t m_xSamples[SamplesCount];
+
+    // Per-Task histogram
+    TaskHandle_t m_xTasks[MaxTasks];
+    uint32_t m_uxTaskSamples[MaxTasks];
+    uint32_t m_uxTasksCount = 0u;
+    uint32_t m_uxOtherSamples = 0u;
+
+    // Per-address histogram, bucket is (pc - m_uxPcStart) >> m_uxPcShift
+    uint32_t m_uxPcSamples[PcBuckets];
+    uintptr_t m_uxPcStart = 0u;
+    uintptr_t m_uxPcEnd = 0u;
+    uint32_t m_uxPcShift = 0u;
+    uint32_t m_uxPcOutOfRange = 0u;
+
+    uint32_t m_uxSamplesTotal = 0u;
+
+public:
+    OSProfiler() : OSProfilerBase(m_xSamples, SamplesCount)
+    {
+        reset();
+    };
+
+    /**
+     * @brief Set address range covered by PC histogram
+     *
+     * @param uxStart First address, e.g. start of .text
+     * @param uxEnd Address after the last one, e.g. end of .text
+     *
+     * @note Bucket size is the smallest power of two covering the range
+     *       with @ref PcBuckets buckets. Map bucket address back
+     *       to function with addr2line or map file.
+     */
+    void setPcRange(uintptr_t uxStart, uintptr_t uxEnd)
+    {
+        assert(uxEnd > uxStart);
+
+        m_uxPcStart = uxStart;
+        m_uxPcEnd = uxEnd;
+        m_uxPcShift = 0u;
+        while (((uxEnd - uxStart - 1u) >> m_uxPcShift) >= PcBuckets) {
+            m_uxPcShift++;
+        }
+    }
+
+    /**
+     * @brief Move samples from the ring into histograms
+     *
+     * @retval Amount of new samples
+     *
+     * @note Call it often enough to keep ring from overflowing
+     */
+    uint32_t aggregate(void)
+    {
+        os_profiler_sample_t xSample;
+        uint32_t uxCount = 0u;
+
+        while (_pop(xSample)) {
+            uxCount++;
+
+            uint32_t i = 0u;
+            for (; i < m_uxTasksCount; i++) {
+                if (m_xTasks[i] == xSample.xTask) {
+                    break;
+                }
+            }
+            if (i == m_uxTasksCount) {
+                if (m_uxTasksCount < MaxTasks) {
+                    m_xTasks[m_uxTasksCount++] = xSample.xTask;
+                    m_uxTaskSamples[i] = 0u;
+                } else {
+                    m_uxOtherSamples++;
+                }
+            }
+            if (i < m_uxTasksCount) {
+                m_uxTaskSamples[i]++;
+            }
+
+            if (xSample.uxPc != 0u) {
+                if ((xSample.uxPc >= m_uxPcStart) && (xSample.uxPc < m_uxPcEnd)) {
+                    m_uxPcSamples[(xSample.uxPc - m_uxPcStart) >> m_uxPcShift]++;
+                } else {
+                    m_uxPcOutOfRange++;
+                }
+            }
+        }
+
+        m_uxSamplesTotal += uxCount;
+        return uxCount;
+    }
+
+    /**
+     * @brief Clear histograms, samples in the ring are kept
+     */
+    void reset(void)
+    {
+        for (uint32_t i = 0u; i < PcBuckets; i++) {
+            m_uxPcSamples[i] = 0u;
+        }
+        m_uxTasksCount = 0u;
+        m_uxOtherSamples = 0u;
+        m_uxPcOutOfRange = 0u;
+        m_uxSamplesTotal = 0u;
+    }
+
+    /**
+     * @brief Get amount of aggregated samples
+     */
+    uint32_t getSamplesTotal(void)
+    {
+        return m_uxSamplesTotal;
+    }
+
+    /**
+     * @brief Get amount of different Tasks seen
+     */
+    uint32_t getTasksCount(void)
+    {
+        return m_uxTasksCount;
+    }
+
+    /**
+     * @brief Get handler of Task from histogram
+     *
+     * @param uxIndex Index in range 0..getTasksCount()
+     *
+     * @note Task might be deleted since sample was taken!
+     */
+    TaskHandle_t getTask(uint32_t uxIndex)
+    {
+        assert(uxIndex < m_uxTasksCount);
+        return (uxIndex < m_uxTasksCount) ? m_xTasks[uxIndex] : nullptr;
+    }
+
+    /**
+     * @brief Get amount of samples of Task from histogram
+     *
+     * @param uxIndex Index in range 0..getTasksCount()
+     */
+    uint32_t getTaskSamples(uint32_t uxIndex)
+    {
+        assert(uxIndex < m_uxTasksCount);
+        return (uxIndex < m_uxTasksCount) ? m_uxTaskSamples[uxIndex] : 0u;
+    }
+
+    /**
+     * @brief Get amount of samples of Tasks which did not fit in MaxTasks
+     */
+    uint32_t getOtherSamples(void)
+    {
+        return m_uxOtherSamples;
+    }
+
+    /**
+     * @brief Get amount of PC histogram buckets
+     */
+    static constexpr uint32_t getPcBucketsCount(void)
+    {
+        return PcBuckets;
+    }
+
+    /**
+     * @brief Get first address covered by PC histogram bucket
+     */
+    uintptr_t getPcBucketAddress(uint32_t uxBucket)
+    {
+        return m_uxPcStart + ((uintptr_t)uxBucket << m_uxPcShift);
+    }
+
+    /**
+     * @brief Get amount of samples in PC histogram bucket
+     */
+    uint32_t getPcBucketSamples(uint32_t uxBucket)
+    {
+        assert(uxBucket < PcBuckets);
+        return (uxBucket < PcBuckets) ? m_uxPcSamples[uxBucket] : 0u;
+    }
+
+    /**
+     * @brief Get amount of PC samples outside of @ref setPcRange()
+     */
+    uint32_t getPcOutOfRange(void)
+    {
+        return m_uxPcOutOfRange;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_PROFILER_HPP
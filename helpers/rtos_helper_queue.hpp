@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "queue.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -45,26 +48,18 @@
 
 
 /**
- * @brief Template class for Queue
+ * @brief Common part of every @ref OSQueue, not depending on item type and amount
  *
- * @code{cpp}
- * // Creation of Queue object with 128 elements of type uint32_t
- * OSQueue <128, uint32_t>TxQueue;
- * ...
- * {
- *     ...
- *     // Call an actual OS Queue creation
- *     TxQueue.init();
- *     ...
- * }
- * @endcode
+ * All the logic lives here and works with items as raw memory,
+ * so it's compiled only once for all Queue objects.
  */
-template <size_t QueueSize, class T>
-class OSQueue
+class OSQueueBase
 {
 private:
     // Amount of items in Queue
     size_t m_xQueueSize = 0u;
+    // Size of single item in bytes
+    size_t m_xItemSize = 0u;
 
     // An OS object handler.
     QueueHandle_t m_xQueueHandler = nullptr;
@@ -75,10 +70,23 @@ private:
 #if (configSUPPORT_STATIC_ALLOCATION == 1)
     // Lines below are OS specific data in RAM created and located at compile time.
     StaticQueue_t m_xControlBlock;
-    T m_xStorage[QueueSize];
+    // Points to the items storage located in @ref OSQueue
+    uint8_t* m_pucStorage = nullptr;
 #endif
 
-    bool _receive(T* val, size_t xMsToWait)
+protected:
+    // Only @ref OSQueue is allowed to create it, as it holds the storage
+    OSQueueBase(size_t xQueueSize, size_t xItemSize, uint8_t* pucStorage)
+            : m_xQueueSize(xQueueSize), m_xItemSize(xItemSize)
+    {
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        m_pucStorage = pucStorage;
+#else
+        (void)pucStorage;
+#endif
+    };
+
+    OS_HOT_SECTION bool _receive(void* val, size_t xMsToWait)
     {
         assert(m_xQueueHandler);
         assert(m_initialized == true);
@@ -87,10 +95,12 @@ private:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xQueueReceive(m_xQueueHandler, reinterpret_cast<void*>(val), pdMS_TO_TICKS(xMsToWait));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xQueueReceiveFromISR(m_xQueueHandler, reinterpret_cast<void*>(val), status);
             yieldFunc(status);
             return res;
@@ -98,14 +108,14 @@ private:
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xQueueReceive(m_xQueueHandler, reinterpret_cast<void*>(val), pdMS_TO_TICKS(xMsToWait));
     } else {
       BaseType_t xHigherPriorityStatus = pdFALSE;
       res = xQueueReceiveFromISR(m_xQueueHandler, reinterpret_cast<void*>(val), &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
@@ -113,7 +123,7 @@ private:
 #endif
     }
 
-    bool _send(const T* val, size_t xMsToWait)
+    OS_HOT_SECTION bool _send(const void* val, size_t xMsToWait)
     {
         assert(m_xQueueHandler);
         assert(m_initialized == true);
@@ -122,10 +132,12 @@ private:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xQueueSend(m_xQueueHandler, reinterpret_cast<const void*>(val), pdMS_TO_TICKS(xMsToWait));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xQueueSendFromISR(m_xQueueHandler, reinterpret_cast<const void*>(val), status);
             yieldFunc(status);
             return res;
@@ -133,14 +145,14 @@ private:
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xQueueSend(m_xQueueHandler, reinterpret_cast<const void*>(val), pdMS_TO_TICKS(xMsToWait));
     } else {
       BaseType_t xHigherPriorityStatus = pdFALSE;
       res = xQueueSendFromISR(m_xQueueHandler, reinterpret_cast<const void*>(val), &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
@@ -148,7 +160,7 @@ private:
 #endif
     }
 
-    bool _peek(T* val, size_t xMsToWait)
+    OS_HOT_SECTION bool _peek(void* val, size_t xMsToWait)
     {
         assert(m_xQueueHandler);
         assert(m_initialized == true);
@@ -157,16 +169,18 @@ private:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xQueuePeek(m_xQueueHandler, reinterpret_cast<void*>(val), pdMS_TO_TICKS(xMsToWait));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             return xQueuePeekFromISR(m_xQueueHandler, reinterpret_cast<void*>(val));
         });
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xQueuePeek(m_xQueueHandler, reinterpret_cast<void*>(val), pdMS_TO_TICKS(xMsToWait));
     } else {
       res = xQueuePeekFromISR(m_xQueueHandler, reinterpret_cast<void*>(val));
@@ -176,10 +190,8 @@ private:
 #endif
     }
 
-public:
-    OSQueue() : m_xQueueSize(QueueSize){};
-
-    ~OSQueue()
+    // Not virtual, so it's protected: Queue must be destroyed only through it's real type
+    ~OSQueueBase()
     {
         assert(m_xQueueHandler);
 
@@ -188,6 +200,7 @@ public:
         m_initialized = false;
     };
 
+public:
     /**
      * @brief Create software Queue with OS functions
      * 
@@ -202,11 +215,11 @@ public:
 
 #if (configSUPPORT_STATIC_ALLOCATION == 1)
         m_xQueueHandler = xQueueCreateStatic(
-                            m_xQueueSize, sizeof(T), reinterpret_cast<uint8_t*>(m_xStorage),
+                            m_xQueueSize, m_xItemSize, m_pucStorage,
                             &m_xControlBlock);
 #else
 
-        m_xQueueHandler = xQueueCreate(m_xQueueSize, sizeof(T));
+        m_xQueueHandler = xQueueCreate(m_xQueueSize, m_xItemSize);
 #endif
 
         assert(m_xQueueHandler);
@@ -252,6 +265,104 @@ public:
         return true;
     }
 
+    /**
+     * @brief Get status flag if Queue is free
+     * 
+     * @return "true" if it's Empty, "false" if not initialised and/or no free space
+     * 
+     * @note 1. This method is thread-safe
+     * @note 2. This method is an ISR safe (?)
+    */
+    bool isEmpty(void)
+    {
+        assert(m_xQueueHandler);
+        assert(m_initialized == true);
+        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+        if (!m_initialized) {
+            return true;
+        }
+
+        bool res = (uxQueueSpacesAvailable(m_xQueueHandler) == m_xQueueSize) ? true : false;
+        return res;
+    }
+
+    /**
+     * @brief Get amount of free items in Queue
+     * 
+     * @retval How much space is left or "-1" if not initialized
+     * 
+     * @note 1. This method is thread-safe
+     * @note 2. This method is an ISR safe (?)
+    */
+    int32_t getFreeSpace(void)
+    {
+        assert(m_xQueueHandler);
+        assert(m_initialized == true);
+        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+        if (!m_initialized) {
+            return -1;
+        }
+
+        int32_t res = (int32_t) uxQueueSpacesAvailable(m_xQueueHandler);
+        return res;  
+    }
+
+    /**
+     * @brief Clear all pending items in Queue
+     * 
+     * @return "true" if successful, "false" if not initialised
+     * 
+     * @note 1. This method is thread-safe
+     * @note 2. This method is an ISR safe (?)
+    */
+    bool fflush(void)
+    {
+        assert(m_xQueueHandler);
+        assert(m_initialized == true);
+        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+        if (!m_initialized) {
+            return false;
+        }
+
+        bool res = (bool)xQueueReset(m_xQueueHandler);
+        return res;
+    }
+};
+
+
+/**
+ * @brief Template class for Queue
+ *
+ * Holds only the storage and typed access, see @ref OSQueueBase for other methods.
+ *
+ * @code{cpp}
+ * // Creation of Queue object with 128 elements of type uint32_t
+ * OSQueue <128, uint32_t>TxQueue;
+ * ...
+ * {
+ *     ...
+ *     // Call an actual OS Queue creation
+ *     TxQueue.init();
+ *     ...
+ * }
+ * @endcode
+ */
+template <size_t QueueSize, class T>
+class OSQueue : public OSQueueBase
+{
+private:
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    // Items storage created and located at compile time.
+    T m_xStorage[QueueSize];
+#endif
+
+public:
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    OSQueue() : OSQueueBase(QueueSize, sizeof(T), reinterpret_cast<uint8_t*>(m_xStorage)){};
+#else
+    OSQueue() : OSQueueBase(QueueSize, sizeof(T), nullptr){};
+#endif
+
     /**
      * @brief Get an item from the Queue
      * 
@@ -263,7 +374,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool receive(T& val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool receive(T& val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _receive(&val, xMsToWait);
     }
@@ -279,7 +390,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool receive(T* val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool receive(T* val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _receive(val, xMsToWait);
     }
@@ -295,7 +406,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool send(const T& val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool send(const T& val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _send(&val, xMsToWait);
     }
@@ -311,7 +422,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool send(const T* val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool send(const T* val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _send(val, xMsToWait);
     }
@@ -327,7 +438,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool peek(T& val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool peek(T& val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _peek(&val, xMsToWait);
     }
@@ -343,73 +454,10 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool peek(T* val, size_t xMsToWait = portMAX_DELAY_MS)
+    OS_HOT_INLINE bool peek(T* val, size_t xMsToWait = portMAX_DELAY_MS)
     {
         return _peek(val, xMsToWait);
     }
-
-    /**
-     * @brief Get status flag if Queue is free
-     * 
-     * @return "true" if it's Empty, "false" if not initialised and/or no free space
-     * 
-     * @note 1. This method is thread-safe
-     * @note 2. This method is an ISR safe (?)
-    */
-    bool isEmpty(void)
-    {
-        assert(m_xQueueHandler);
-        assert(m_initialized == true);
-        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
-        if (!m_initialized) {
-            return true;
-        }
-
-        bool res = (uxQueueSpacesAvailable(m_xQueueHandler) == m_xQueueSize) ? true : false;
-        return res;
-    }
-
-    /**
-     * @brief Get amount of free items in Queue
-     * 
-     * @retval How much space is left or "-1" if not initialized
-     * 
-     * @note 1. This method is thread-safe
-     * @note 2. This method is an ISR safe (?)
-    */
-    int32_t getFreeSpace(void)
-    {
-        assert(m_xQueueHandler);
-        assert(m_initialized == true);
-        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
-        if (!m_initialized) {
-            return -1;
-        }
-
-        int32_t res = (int32_t) uxQueueSpacesAvailable(m_xQueueHandler);
-        return res;  
-    }
-
-    /**
-     * @brief Clear all pending items in Queue
-     * 
-     * @return "true" if successful, "false" if not initialised
-     * 
-     * @note 1. This method is thread-safe
-     * @note 2. This method is an ISR safe (?)
-    */
-    bool fflush(void)
-    {
-        assert(m_xQueueHandler);
-        assert(m_initialized == true);
-        assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
-        if (!m_initialized) {
-            return false;
-        }
-
-        bool res = (bool)xQueueReset(m_xQueueHandler);
-        return res;
-    }
 };
 
 // - - - - - - - - - - - - - - - - - - - - - - - -
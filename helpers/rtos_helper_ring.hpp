@@ -0,0 +1,255 @@
+/**
+ * @file rtos_helper_ring.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_RING_HPP
+#define _RTOS_HELPER_RING_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Untyped part of @ref OSLockFreeRing
+ *
+ * Bounded multi-producer multi-consumer ring with per-cell sequence numbers
+ * (D. Vyukov's algorithm). Producers and consumers only contend on CAS
+ * of their own index, no lock is ever taken.
+ *
+ * @note Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSLockFreeRingBase
+{
+private:
+    // Sequence number of every cell, tells whose turn it is
+    OSAtomic<uint32_t>* m_pxSeq = nullptr;
+    uint8_t* m_pucStorage = nullptr;
+    size_t m_xItemSize = 0u;
+    uint32_t m_uxMask = 0u;
+
+    OSAtomic<uint32_t> m_uxEnqueuePos;
+    OSAtomic<uint32_t> m_uxDequeuePos;
+
+protected:
+    // Only @ref OSLockFreeRing is allowed to create it, as it holds the storage
+    OSLockFreeRingBase(OSAtomic<uint32_t>* pxSeq, uint8_t* pucStorage,
+                        size_t xItemSize, uint32_t uxSize)
+                                : m_pxSeq(pxSeq), m_pucStorage(pucStorage),
+                                m_xItemSize(xItemSize), m_uxMask(uxSize - 1u) {};
+
+    // Mark every cell as free, must be called once storage is constructed
+    void _reset(void)
+    {
+        for (uint32_t i = 0u; i <= m_uxMask; i++) {
+            m_pxSeq[i].store(i);
+        }
+        m_uxEnqueuePos.store(0u);
+        m_uxDequeuePos.store(0u);
+    }
+
+    /**
+     * @brief Put an item into the ring
+     *
+     * @param pvItem Item to copy
+     *
+     * @return "true" if successful, "false" if ring is full
+     */
+    OS_HOT_SECTION bool _push(const void* pvItem)
+    {
+        uint32_t uxPos = m_uxEnqueuePos.load();
+
+        for (;;) {
+            OSAtomic<uint32_t>& xSeq = m_pxSeq[uxPos & m_uxMask];
+            int32_t diff = (int32_t)(xSeq.load() - uxPos);
+
+            if (diff == 0) {
+                if (m_uxEnqueuePos.compareExchange(uxPos, uxPos + 1u)) {
+                    memcpy(&m_pucStorage[(uxPos & m_uxMask) * m_xItemSize], pvItem, m_xItemSize);
+                    xSeq.store(uxPos + 1u);
+                    return true;
+                }
+                // uxPos is reloaded by failed CAS
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                uxPos = m_uxEnqueuePos.load();
+            }
+        }
+    }
+
+    /**
+     * @brief Take an item from the ring
+     *
+     * @param pvItem Where to copy the item
+     *
+     * @return "true" if successful, "false" if ring is empty
+     */
+    OS_HOT_SECTION bool _pop(void* pvItem)
+    {
+        uint32_t uxPos = m_uxDequeuePos.load();
+
+        for (;;) {
+            OSAtomic<uint32_t>& xSeq = m_pxSeq[uxPos & m_uxMask];
+            int32_t diff = (int32_t)(xSeq.load() - (uxPos + 1u));
+
+            if (diff == 0) {
+                if (m_uxDequeuePos.compareExchange(uxPos, uxPos + 1u)) {
+                    memcpy(pvItem, &m_pucStorage[(uxPos & m_uxMask) * m_xItemSize], m_xItemSize);
+                    xSeq.store(uxPos + m_uxMask + 1u);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty, or producer is still copying
+            } else {
+                uxPos = m_uxDequeuePos.load();
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Check if there is no items in the ring
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    bool isEmpty(void)
+    {
+        return (m_uxEnqueuePos.load() == m_uxDequeuePos.load());
+    }
+
+    /**
+     * @brief Get amount of items in the ring
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getCount(void)
+    {
+        return m_uxEnqueuePos.load() - m_uxDequeuePos.load();
+    }
+};
+
+
+/**
+ * @brief Bounded lock-free ring for any amount of producers and consumers
+ *
+ * @code{cpp}
+ * OSLockFreeRing<Event, 16> events;
+ * ...
+ * // In any ISR, Task or core:
+ * if (!events.push(ev)) {
+ *     // full
+ * }
+ * ...
+ * Event ev;
+ * while (events.pop(ev)) {
+ *     handle(ev);
+ * }
+ * @endcode
+ *
+ * @tparam T Trivially copyable item type
+ * @tparam Size Amount of items, must be power of two
+ *
+ * @note 1. This class is thread-safe, multi-core safe and an ISR safe
+ * @note 2. It never blocks: push() and pop() return "false" instead.
+ *          pop() may also return "false" while preempted producer is
+ *          in the middle of copying its item.
+ */
+template <class T, uint32_t Size>
+class OSLockFreeRing : public OSLockFreeRingBase
+{
+    static_assert((Size != 0u) && ((Size & (Size - 1u)) == 0u), "Size must be power of two");
+
+private:
+    OSAtomic<uint32_t> m_xSeq[Size];
+    T m_xStorage[Size];
+
+public:
+    OSLockFreeRing() : OSLockFreeRingBase(m_xSeq, reinterpret_cast<uint8_t*>(m_xStorage),
+                                          sizeof(T), Size)
+    {
+        _reset();
+    };
+
+    /**
+     * @brief Put an item into the ring
+     *
+     * @param xItem Item to copy
+     *
+     * @return "true" if successful, "false" if ring is full
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE bool push(const T& xItem)
+    {
+        return _push(&xItem);
+    }
+
+    /**
+     * @brief Take an item from the ring
+     *
+     * @param xItem Where to copy the item
+     *
+     * @return "true" if successful, "false" if ring is empty
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE bool pop(T& xItem)
+    {
+        return _pop(&xItem);
+    }
+
+    /**
+     * @brief Get capacity of the ring
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return Size;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_RING_HPP
@@ -0,0 +1,345 @@
+/**
+ * @file rtos_helper_rpc.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_RPC_HPP
+#define _RTOS_HELPER_RPC_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_task.hpp"
+#include "rtos_helper_counter.hpp"
+#include "rtos_helper_mutex.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Request in flight, lives on the client's stack till the reply
+typedef struct os_rpc_envelope {
+    TaskHandle_t xClient;    // Who waits for the reply
+    UBaseType_t uxPriority;  // Priority donated to the server
+    const void* pvRequest;
+    void* pvResponse;
+    struct os_rpc_envelope* pxNext; // Next pending request, lower or same priority
+} os_rpc_envelope_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+#if ((configUSE_MUTEXES == 1) && (configUSE_TASK_NOTIFICATIONS == 1) && (configUSE_COUNTING_SEMAPHORES == 1) && \
+     (INCLUDE_vTaskPrioritySet == 1) && (INCLUDE_uxTaskPriorityGet == 1) && \
+     (INCLUDE_xTaskGetCurrentTaskHandle == 1))
+/**
+ * @brief Non-template part of @ref OSRpc, keeps track of donated priorities
+ *
+ * Server always runs at the highest priority of its own one
+ * and priorities of all clients with pending requests.
+ * Pending requests are kept in a list sorted by client priority.
+ */
+class OSRpcBase
+{
+private:
+    OSTaskBase& m_xServer;
+    // Guards the bookkeeping below, its own inheritance is harmless
+    OSMutex m_xLock;
+
+    // Amount of pending requests per client priority
+    uint16_t m_usPending[configMAX_PRIORITIES];
+    // Priority currently set to the server
+    UBaseType_t m_uxApplied = tskIDLE_PRIORITY;
+    // Highest priority request first, FIFO within the same priority
+    os_rpc_envelope_t* m_pxHead = nullptr;
+
+    // Must be called with m_xLock taken
+    void _apply(void)
+    {
+        UBaseType_t uxTarget = m_xServer.getPriority();
+
+        for (UBaseType_t i = configMAX_PRIORITIES - 1u; i > uxTarget; i--) {
+            if (m_usPending[i] != 0u) {
+                uxTarget = i;
+                break;
+            }
+        }
+
+        if (uxTarget != m_uxApplied) {
+            m_uxApplied = uxTarget;
+            vTaskPrioritySet(m_xServer.getHandler(), uxTarget);
+        }
+    }
+
+protected:
+    OSRpcBase(OSTaskBase& xServer) : m_xServer(xServer)
+    {
+        for (UBaseType_t i = 0u; i < configMAX_PRIORITIES; i++) {
+            m_usPending[i] = 0u;
+        }
+    };
+
+    bool _init(void)
+    {
+        m_uxApplied = m_xServer.getPriority();
+        return m_xLock.init();
+    }
+
+    // Raise server priority before the request is queued
+    void _donate(UBaseType_t uxPriority)
+    {
+        // Server calling itself would wait for the reply forever
+        assert(xTaskGetCurrentTaskHandle() != m_xServer.getHandler());
+
+        m_xLock.lock();
+        m_usPending[uxPriority]++;
+        _apply();
+        m_xLock.unlock();
+    }
+
+    // Drop donation of a finished (or not queued) request
+    void _withdraw(UBaseType_t uxPriority)
+    {
+        m_xLock.lock();
+        assert(m_usPending[uxPriority] != 0u);
+        m_usPending[uxPriority]--;
+        _apply();
+        m_xLock.unlock();
+    }
+
+    // Put request in line behind all requests of the same or higher priority
+    void _enqueue(os_rpc_envelope_t& xEnvelope)
+    {
+        m_xLock.lock();
+        os_rpc_envelope_t** ppxNext = &m_pxHead;
+        while ((*ppxNext != nullptr) && ((*ppxNext)->uxPriority >= xEnvelope.uxPriority)) {
+            ppxNext = &(*ppxNext)->pxNext;
+        }
+        xEnvelope.pxNext = *ppxNext;
+        *ppxNext = &xEnvelope;
+        m_xLock.unlock();
+    }
+
+    // Take the highest priority request
+    os_rpc_envelope_t* _dequeue(void)
+    {
+        m_xLock.lock();
+        os_rpc_envelope_t* pxEnvelope = m_pxHead;
+        if (pxEnvelope != nullptr) {
+            m_pxHead = pxEnvelope->pxNext;
+        }
+        m_xLock.unlock();
+        return pxEnvelope;
+    }
+
+    // Block client till the server replies
+    static void _waitReply(void)
+    {
+        OS_HELPER_SCHED_POINT();
+
+        while (ulTaskNotifyTakeIndexed(OS_HELPER_NOTIFY_INDEX, pdTRUE, portMAX_DELAY) == 0u) {
+            portNOP();
+        }
+    }
+
+    // Wake up the client, then give donated priority back
+    void _reply(const os_rpc_envelope_t& xEnvelope)
+    {
+        OS_HELPER_SCHED_POINT();
+
+        // Envelope is gone as soon as the client wakes up
+        const UBaseType_t uxPriority = xEnvelope.uxPriority;
+
+        // Client is woken up first, so server is never preempted
+        // by a middle priority Task while client still waits
+        xTaskNotifyGiveIndexed(xEnvelope.xClient, OS_HELPER_NOTIFY_INDEX);
+        _withdraw(uxPriority);
+    }
+
+public:
+    /**
+     * @brief Get priority the server currently runs with
+     */
+    UBaseType_t getServerPriority(void)
+    {
+        return m_uxApplied;
+    }
+};
+
+
+/**
+ * @brief Synchronous request/response channel with priority donation
+ *
+ * Client blocks in @ref call() till the server Task handles its request.
+ * Meanwhile server inherits priority of the highest waiting client,
+ * so a low priority server does not turn into unbounded priority inversion
+ * for a high priority client, as it would with a plain pair of Queues.
+ * Requests are served in order of client priority, FIFO within the same one,
+ * so a high priority client waits at most for the request being handled,
+ * not for every queued background request.
+ *
+ * @code{cpp}
+ * OSTask <4096> StorageTask(vStorageTask, "Storage", nullptr, tskIDLE_PRIORITY + 1);
+ * OSRpc<ReadCmd, ReadResult, 4> Storage(StorageTask);
+ * ...
+ * Storage.init();
+ * ...
+ * // Any Task:
+ * ReadResult res;
+ * Storage.call(ReadCmd{addr, len}, res);
+ * ...
+ * void vStorageTask(void* pvArg)
+ * {
+ *     for (;;) {
+ *         Storage.serve([](const ReadCmd& cmd, ReadResult& res) {
+ *             res.status = flashRead(cmd.addr, cmd.len, res.data);
+ *         });
+ *     }
+ * }
+ * @endcode
+ *
+ * @tparam Req Type of request
+ * @tparam Resp Type of response
+ * @tparam QueueSize Max amount of pending requests
+ *
+ * @note 1. Client waits for the reply on OS_HELPER_NOTIFY_INDEX notification.
+ * @note 2. Do not call it inside ISR context!
+ * @note 3. Server priority is managed by this class, don't change it by hand.
+ * @note 4. When all QueueSize slots are taken, clients wait for a free one
+ *          in priority order too (semaphore waiters are sorted by the kernel).
+ */
+template <class Req, class Resp, size_t QueueSize>
+class OSRpc : public OSRpcBase
+{
+private:
+    // Free places for pending requests
+    Counter<QueueSize> m_xSlots;
+    // Amount of requests in the list, server waits on it
+    Counter<QueueSize> m_xRequests;
+
+public:
+    /**
+     * @param xServer Task which will call @ref serve()
+     */
+    OSRpc(OSTaskBase& xServer) : OSRpcBase(xServer) {};
+
+    /**
+     * @brief Create OS objects of the channel
+     *
+     * @return "true" if successful, "false" if not initialised
+     *
+     * @note Server Task must be created before the first @ref call()
+     */
+    bool init(void)
+    {
+        if (!m_xSlots.init() || !m_xRequests.init()) {
+            return false;
+        }
+
+        for (size_t i = 0u; i < QueueSize; i++) {
+            m_xSlots.give();
+        }
+
+        return _init();
+    }
+
+    /**
+     * @brief Send request and wait for response
+     *
+     * @param xRequest Request handed to the server
+     * @param xResponse Where server puts the response
+     * @param xMsToWait Max time to wait for a free slot
+     *
+     * @return "true" if response is received, "false" if all slots stayed taken
+     *
+     * @note Once queued, request can't be cancelled, so reply is waited without timeout
+     */
+    bool call(const Req& xRequest, Resp& xResponse, size_t xMsToWait = portMAX_DELAY_MS)
+    {
+        os_rpc_envelope_t xEnvelope = {
+            xTaskGetCurrentTaskHandle(), uxTaskPriorityGet(nullptr), &xRequest, &xResponse, nullptr
+        };
+
+        // Server finishes current requests faster while client waits for a slot
+        _donate(xEnvelope.uxPriority);
+
+        if (!m_xSlots.take(xMsToWait)) {
+            _withdraw(xEnvelope.uxPriority);
+            return false;
+        }
+
+        _enqueue(xEnvelope);
+        m_xRequests.give();
+
+        _waitReply();
+        return true;
+    }
+
+    /**
+     * @brief Handle the highest priority pending request
+     *
+     * @param xHandler Callable with (const Req&, Resp&) arguments
+     * @param xMsToWait Max time to wait for a request
+     *
+     * @return "true" if request was handled, "false" if none arrived
+     *
+     * @note Must be called inside of server Task's code !
+     */
+    template <class Handler>
+    bool serve(Handler xHandler, size_t xMsToWait = portMAX_DELAY_MS)
+    {
+        if (!m_xRequests.take(xMsToWait)) {
+            return false;
+        }
+
+        os_rpc_envelope_t* pxEnvelope = _dequeue();
+        assert(pxEnvelope != nullptr);
+
+        xHandler(*static_cast<const Req*>(pxEnvelope->pvRequest),
+                 *static_cast<Resp*>(pxEnvelope->pvResponse));
+
+        _reply(*pxEnvelope);
+        m_xSlots.give();
+        return true;
+    }
+};
+#endif // configUSE_MUTEXES && configUSE_TASK_NOTIFICATIONS && configUSE_COUNTING_SEMAPHORES && INCLUDE_vTaskPrioritySet
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_RPC_HPP
@@ -0,0 +1,246 @@
+/**
+ * @file rtos_helper_sched_analysis.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_SCHED_ANALYSIS_HPP
+#define _RTOS_HELPER_SCHED_ANALYSIS_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Priority of the Task is derived from its period (rate-monotonic)
+#define OS_TASK_PRIORITY_RM ((UBaseType_t)~(UBaseType_t)0u)
+
+// Lowest priority given by rate-monotonic assignment
+#ifndef OS_TASK_RM_BASE_PRIORITY
+#define OS_TASK_RM_BASE_PRIORITY (tskIDLE_PRIORITY + 1u)
+#endif // OS_TASK_RM_BASE_PRIORITY
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Timing description of a periodic (or sporadic) Task
+ *
+ * All times must be in the same units (ticks, microseconds...).
+ */
+struct OSTaskSpec {
+    uint32_t uxPeriod;       // Period or minimal inter-arrival time
+    uint32_t uxWcet;         // Worst case execution time budget
+    UBaseType_t uxPriority;  // FreeRTOS priority or OS_TASK_PRIORITY_RM
+    uint32_t uxBlocking;     // Longest blocking by lower priority Tasks (Mutex, critical sections)
+    uint32_t uxDeadline;     // Relative deadline, equal to period if 0
+
+    constexpr OSTaskSpec(uint32_t period, uint32_t wcet,
+                         UBaseType_t priority = OS_TASK_PRIORITY_RM,
+                         uint32_t blocking = 0u, uint32_t deadline = 0u)
+                                : uxPeriod(period), uxWcet(wcet), uxPriority(priority),
+                                uxBlocking(blocking), uxDeadline((deadline != 0u) ? deadline : period) {}
+};
+
+
+/**
+ * @brief Compile-time response-time analysis of a fixed priority Task set
+ *
+ * Worst case response time of every Task is the fixed point of
+ *   R = C + B + sum(ceil(R / Tj) * Cj)
+ * over all other Tasks with higher or equal priority
+ * (equal priority is counted as interference, as FreeRTOS time slices them).
+ *
+ * @code{cpp}
+ * constexpr OSTaskSpec kTasks[] = {
+ *     // period, wcet, priority, blocking (all in microseconds)
+ *     {1000u,  200u},                   // control loop, RM priority
+ *     {5000u,  1000u, OS_TASK_PRIORITY_RM, 50u},
+ *     {20000u, 4000u},
+ * };
+ * static_assert(OSSchedAnalysis::isSchedulable(kTasks), "Deadlines can be missed!");
+ * static_assert(OSSchedAnalysis::prioritiesFit(kTasks), "Not enough priorities!");
+ *
+ * OSTask <2048> ControlTask(vControlTask, "Control", nullptr, OSSchedAnalysis::priority(kTasks, 0));
+ * @endcode
+ *
+ * @note Everything is constexpr, so nothing gets into firmware.
+ */
+class OSSchedAnalysis
+{
+private:
+    template <size_t N>
+    static constexpr bool _isFirstOfPeriod(const OSTaskSpec (&xTasks)[N], size_t j, size_t k)
+    {
+        return (k >= j) || ((!((xTasks[k].uxPriority == OS_TASK_PRIORITY_RM) &&
+                                (xTasks[k].uxPeriod == xTasks[j].uxPeriod))) &&
+                            _isFirstOfPeriod(xTasks, j, k + 1u));
+    }
+
+    // Amount of different longer periods among rate-monotonic Tasks
+    template <size_t N>
+    static constexpr UBaseType_t _longerPeriods(const OSTaskSpec (&xTasks)[N], size_t i, size_t j)
+    {
+        return (j >= N) ? 0u :
+               (((xTasks[j].uxPriority == OS_TASK_PRIORITY_RM) &&
+                 (xTasks[j].uxPeriod > xTasks[i].uxPeriod) &&
+                 _isFirstOfPeriod(xTasks, j, 0u)) ? 1u : 0u) + _longerPeriods(xTasks, i, j + 1u);
+    }
+
+    static constexpr uint64_t _ceilDiv(uint64_t a, uint64_t b)
+    {
+        return (a + b - 1u) / b;
+    }
+
+    template <size_t N>
+    static constexpr uint64_t _interference(const OSTaskSpec (&xTasks)[N], size_t i, uint64_t R, size_t j)
+    {
+        return (j >= N) ? 0u :
+               (((j != i) && (priority(xTasks, j) >= priority(xTasks, i))) ?
+                    _ceilDiv(R, xTasks[j].uxPeriod) * xTasks[j].uxWcet : 0u) +
+               _interference(xTasks, i, R, j + 1u);
+    }
+
+    template <size_t N>
+    static constexpr uint64_t _next(const OSTaskSpec (&xTasks)[N], size_t i, uint64_t R)
+    {
+        return (uint64_t)xTasks[i].uxWcet + xTasks[i].uxBlocking + _interference(xTasks, i, R, 0u);
+    }
+
+    // Stop at the fixed point, or as soon as the deadline is exceeded
+    template <size_t N>
+    static constexpr uint64_t _iterate(const OSTaskSpec (&xTasks)[N], size_t i, uint64_t R, uint64_t next)
+    {
+        return ((next == R) || (next > xTasks[i].uxDeadline)) ? next :
+               _iterate(xTasks, i, next, _next(xTasks, i, next));
+    }
+
+    template <size_t N>
+    static constexpr bool _allFrom(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return (i >= N) || (isTaskSchedulable(xTasks, i) && _allFrom(xTasks, i + 1u));
+    }
+
+    template <size_t N>
+    static constexpr bool _fitFrom(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return (i >= N) || ((priority(xTasks, i) < (UBaseType_t)configMAX_PRIORITIES) && _fitFrom(xTasks, i + 1u));
+    }
+
+    template <size_t N>
+    static constexpr uint32_t _utilizationFrom(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return (i >= N) ? 0u :
+               (uint32_t)(((uint64_t)xTasks[i].uxWcet * 1000u) / xTasks[i].uxPeriod) + _utilizationFrom(xTasks, i + 1u);
+    }
+
+public:
+    /**
+     * @brief Get effective priority of the Task
+     *
+     * @param xTasks Task set
+     * @param i Index of the Task
+     *
+     * @retval Priority given in spec, or rate-monotonic one:
+     *         the shorter period - the higher priority, equal periods share priority
+     */
+    template <size_t N>
+    static constexpr UBaseType_t priority(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return (xTasks[i].uxPriority != OS_TASK_PRIORITY_RM) ? xTasks[i].uxPriority :
+               (UBaseType_t)(OS_TASK_RM_BASE_PRIORITY + _longerPeriods(xTasks, i, 0u));
+    }
+
+    /**
+     * @brief Get worst case response time of the Task
+     *
+     * @param xTasks Task set
+     * @param i Index of the Task
+     *
+     * @retval Response time, or first value above deadline if Task is not schedulable
+     */
+    template <size_t N>
+    static constexpr uint64_t responseTime(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return _iterate(xTasks, i, (uint64_t)xTasks[i].uxWcet + xTasks[i].uxBlocking,
+                        _next(xTasks, i, (uint64_t)xTasks[i].uxWcet + xTasks[i].uxBlocking));
+    }
+
+    /**
+     * @brief Check if the Task always meets its deadline
+     */
+    template <size_t N>
+    static constexpr bool isTaskSchedulable(const OSTaskSpec (&xTasks)[N], size_t i)
+    {
+        return (xTasks[i].uxPeriod != 0u) && (responseTime(xTasks, i) <= xTasks[i].uxDeadline);
+    }
+
+    /**
+     * @brief Check if every Task of the set always meets its deadline
+     */
+    template <size_t N>
+    static constexpr bool isSchedulable(const OSTaskSpec (&xTasks)[N])
+    {
+        return _allFrom(xTasks, 0u);
+    }
+
+    /**
+     * @brief Check if every effective priority is below configMAX_PRIORITIES
+     */
+    template <size_t N>
+    static constexpr bool prioritiesFit(const OSTaskSpec (&xTasks)[N])
+    {
+        return _fitFrom(xTasks, 0u);
+    }
+
+    /**
+     * @brief Get total CPU utilization of the set
+     *
+     * @retval Utilization in 1/1000, 1000 - CPU is fully loaded
+     */
+    template <size_t N>
+    static constexpr uint32_t utilizationPermille(const OSTaskSpec (&xTasks)[N])
+    {
+        return _utilizationFrom(xTasks, 0u);
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_SCHED_ANALYSIS_HPP
@@ -0,0 +1,244 @@
+/**
+ * @file rtos_helper_sched_explorer.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_SCHED_EXPLORER_HPP
+#define _RTOS_HELPER_SCHED_EXPLORER_HPP
+
+#ifdef _RTOS_HELPER_CORE_HPP
+#error "rtos_helper_sched_explorer.hpp must be included before any other helper!"
+#endif
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Seeded interleaving explorer for host test builds
+ *
+ * Every helper method which signals or blocks passes through
+ * @ref OS_HELPER_SCHED_POINT(). This class turns that hook into
+ * a pseudo random preemption point driven by a single seed.
+ * It is NOT a simulated kernel: Tasks run on the real FreeRTOS POSIX port,
+ * the explorer only decides where the running Task gives up the CPU.
+ *
+ * Schedule repeats exactly for the same seed when all of these hold:
+ *  - kernel is built with time slicing off (OS_HOST_TIME_SLICING=0 in extras/posix);
+ *  - scenario Tasks have equal priority and never sleep or wait with a timeout;
+ *  - preemption is yield only (default, maxDelayTicks = 0).
+ * Then every switch is caused by a yield or a block, never by the host timer.
+ * @ref getTraceHash() tells if a replay has taken the same path.
+ * No real time is spent at points, so thousands of schedules per second can be run.
+ *
+ * @code{cpp}
+ * // Must be the very first include in test code
+ * #include "helpers/rtos_helper_sched_explorer.hpp"
+ * #include "FreeRTOS_helper.hpp"
+ * ...
+ * for (uint32_t seed = 1u; seed < 10000u; seed++) {
+ *     OSSchedExplorer::seed(seed);
+ *     if (!runScenario()) { // start tasks, wait for them, check invariants
+ *         failedSeed = seed;
+ *         failedHash = OSSchedExplorer::getTraceHash();
+ *     }
+ * }
+ * ...
+ * OSSchedExplorer::seed(failedSeed); // replay
+ * runScenario();
+ * assert(OSSchedExplorer::getTraceHash() == failedHash);
+ * @endcode
+ *
+ * @note 1. Intended for the FreeRTOS POSIX port (see OS_HELPER_VANILLA_FREERTOS).
+ * @note 2. Delays, timeouts, software Timers and time slicing still depend on
+ *          the host timer, with them decisions repeat but the schedule may not.
+ * @note 3. Decisions are taken only in Task context, ISR calls are ignored.
+ */
+class OSSchedExplorer
+{
+private:
+    struct State {
+        // Current value of xorshift32 generator
+        uint32_t rnd = 1u;
+        // Probability of preemption in percents at each point
+        uint8_t yieldRatio = 50u;
+        // Max amount of ticks to sleep instead of plain yield (0 - only yield)
+        uint8_t maxDelayTicks = 0u;
+        // Statistic counters for the current seed
+        uint32_t points = 0u;
+        uint32_t yields = 0u;
+        // FNV-1a of (Task, decision) at every point
+        uint32_t trace = 2166136261u;
+    };
+
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    static void trace(uint32_t uxValue)
+    {
+        for (uint32_t i = 0u; i < 4u; i++) {
+            state().trace ^= (uxValue >> (i * 8u)) & 0xFFu;
+            state().trace *= 16777619u;
+        }
+    }
+
+    static uint32_t next()
+    {
+        uint32_t x = state().rnd;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state().rnd = x;
+        return x;
+    }
+
+public:
+    /**
+     * @brief Restart exploration with new seed
+     *
+     * @param newSeed Any value, zero is replaced by one
+     *
+     * @note Must be called before scenario Tasks are started
+     */
+    static void seed(uint32_t newSeed)
+    {
+        state().rnd = (newSeed != 0u) ? newSeed : 1u;
+        state().points = 0u;
+        state().yields = 0u;
+        state().trace = 2166136261u;
+    }
+
+    /**
+     * @brief Set how aggressive preemption will be
+     *
+     * @param ratio Probability in percents (0..100) to preempt at each point
+     * @param maxDelayTicks Max sleep in ticks instead of yield,
+     *                      lets lower priority Tasks run in, but makes
+     *                      the schedule depend on real time (and slow).
+     */
+    static void configure(uint8_t ratio, uint8_t maxDelayTicks = 0u)
+    {
+        assert(ratio <= 100u);
+        state().yieldRatio = ratio;
+        state().maxDelayTicks = maxDelayTicks;
+    }
+
+    /**
+     * @brief Decision point, called by @ref OS_HELPER_SCHED_POINT()
+     *
+     * @param xInsideIsr Result of OS_HELPER_IS_INSIDE_ISR() at the call site
+     *
+     * @note Hook is expanded before ISR branch of helpers, so it's reached from ISR too,
+     *       where neither vTaskDelay() nor taskYIELD() is allowed.
+     */
+    static void point(BaseType_t xInsideIsr)
+    {
+        if (xInsideIsr != pdFALSE) {
+            return;
+        }
+
+        if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+            return;
+        }
+
+        state().points++;
+
+        uint32_t r = next();
+        bool preempt = ((r % 100u) < state().yieldRatio);
+        // Pointers of static Tasks are the same from run to run of the same binary
+        trace((uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle());
+        trace(preempt ? 1u : 0u);
+        if (!preempt) {
+            return;
+        }
+
+        state().yields++;
+
+        uint32_t ticks = (state().maxDelayTicks != 0u) ? ((r >> 8) % (state().maxDelayTicks + 1u)) : 0u;
+        if (ticks != 0u) {
+            vTaskDelay((TickType_t)ticks);
+        } else {
+            taskYIELD();
+        }
+    }
+
+    /**
+     * @brief Get amount of passed scheduling points since last @ref seed()
+     */
+    static uint32_t getPointsCount()
+    {
+        return state().points;
+    }
+
+    /**
+     * @brief Get amount of forced preemptions since last @ref seed()
+     */
+    static uint32_t getYieldsCount()
+    {
+        return state().yields;
+    }
+
+    /**
+     * @brief Get fingerprint of the path taken since last @ref seed()
+     *
+     * @note Same value for replay of the same seed means same schedule,
+     *       only valid within the same binary
+     */
+    static uint32_t getTraceHash()
+    {
+        return state().trace;
+    }
+};
+
+#ifndef OS_HELPER_SCHED_POINT
+// Context is checked where hook is expanded, after rtos_helper_core.hpp
+// or rtos_helper_isr_sim.hpp has defined OS_HELPER_IS_INSIDE_ISR()
+#define OS_HELPER_SCHED_POINT() OSSchedExplorer::point(OS_HELPER_IS_INSIDE_ISR())
+#endif // OS_HELPER_SCHED_POINT
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_SCHED_EXPLORER_HPP
@@ -0,0 +1,420 @@
+/**
+ * @file rtos_helper_shared_buf.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_SHARED_BUF_HPP
+#define _RTOS_HELPER_SHARED_BUF_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+#include "rtos_helper_lf_stack.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Alignment of data of every shared buffer
+#ifndef OS_SHARED_BUF_ALIGN
+#define OS_SHARED_BUF_ALIGN 8u
+#endif // OS_SHARED_BUF_ALIGN
+
+class OSSharedBufPoolBase;
+
+// Control block of a shared buffer
+typedef struct os_shared_buf_t {
+    OSSharedBufPoolBase* pxPool;    // Where to return it
+    uint8_t* pucData;
+    uint32_t uxLength;              // Amount of valid bytes
+    OSAtomic<uint32_t> uxRefs;
+} os_shared_buf_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Untyped part of @ref OSSharedBufPool
+ *
+ * @note Non-template, so it stays in @ref OS_HOT_SECTION
+ */
+class OSSharedBufPoolBase
+{
+private:
+    os_shared_buf_t* m_pxBufs = nullptr;
+    uint32_t m_uxCapacity = 0u;
+
+    // Free buffers by index, no lock on alloc and release where OSAtomic is native
+    OSLockFreeStackBase m_xFree;
+    OSAtomic<uint32_t> m_uxFreeCount;
+
+    friend class OSSharedBuf;
+
+    // Called by the last owner only
+    OS_HOT_SECTION void _free(os_shared_buf_t* pxBuf)
+    {
+        m_uxFreeCount.fetchAdd(1u);
+        m_xFree.pushIndex((uint32_t)(pxBuf - m_pxBufs));
+    }
+
+protected:
+    // Only @ref OSSharedBufPool is allowed to create it, as it holds the storage
+    OSSharedBufPoolBase(os_shared_buf_t* pxBufs, OSAtomic<uint32_t>* pxLinks,
+                        uint32_t uxCount, uint32_t uxCapacity)
+                                : m_pxBufs(pxBufs), m_uxCapacity(uxCapacity), m_xFree(pxLinks, uxCount) {};
+
+    // Put every buffer into the free list, must be called once storage is constructed
+    void _reset(uint8_t* pucData, uint32_t uxStride, uint32_t uxCount)
+    {
+        for (uint32_t i = uxCount; i > 0u; i--) {
+            os_shared_buf_t& xBuf = m_pxBufs[i - 1u];
+            xBuf.pxPool = this;
+            xBuf.pucData = &pucData[(i - 1u) * uxStride];
+            xBuf.uxLength = 0u;
+            xBuf.uxRefs.store(0u);
+            m_xFree.pushIndex(i - 1u);
+        }
+        m_uxFreeCount.store(uxCount);
+    }
+
+    /**
+     * @brief Take a free buffer, its only reference goes to the caller
+     *
+     * @retval Buffer, nullptr if pool is exhausted
+     */
+    OS_HOT_SECTION os_shared_buf_t* _alloc(void)
+    {
+        uint32_t uxIndex = m_xFree.popIndex();
+        if (uxIndex == OS_LOCK_FREE_STACK_EMPTY) {
+            return nullptr;
+        }
+        m_uxFreeCount.fetchSub(1u);
+
+        os_shared_buf_t* pxBuf = &m_pxBufs[uxIndex];
+        pxBuf->uxLength = 0u;
+        pxBuf->uxRefs.store(1u);
+        return pxBuf;
+    }
+
+public:
+    /**
+     * @brief Get size of every buffer in bytes
+     */
+    uint32_t getCapacity(void)
+    {
+        return m_uxCapacity;
+    }
+
+    /**
+     * @brief Get amount of free buffers
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getFreeCount(void)
+    {
+        return m_uxFreeCount.load();
+    }
+};
+
+
+/**
+ * @brief Counted reference to a buffer of @ref OSSharedBufPool
+ *
+ * Copy adds a reference, destruction drops it. The last one
+ * returns the buffer to its pool. Content is written only while
+ * the reference is unique, after that it's read-only for everyone.
+ *
+ * To pass it through OSQueue use a raw reference:
+ * @ref share() on the sender side, then constructor or @ref attach()
+ * on the receiver side, which takes it over.
+ *
+ * @note 1. All methods are an ISR safe, release included.
+ * @note 2. A single handle is NOT thread-safe, each Task uses its own copy.
+ */
+class OSSharedBuf
+{
+private:
+    os_shared_buf_t* m_pxBuf = nullptr;
+
+public:
+    OSSharedBuf() {};
+
+    /**
+     * @param pxBuf Raw reference to take over, e.g. received from a Queue
+     */
+    explicit OSSharedBuf(os_shared_buf_t* pxBuf) : m_pxBuf(pxBuf) {};
+
+    OSSharedBuf(const OSSharedBuf& xOther) : m_pxBuf(xOther.share()) {};
+
+    OSSharedBuf(OSSharedBuf&& xOther) : m_pxBuf(xOther.detach()) {};
+
+    OSSharedBuf& operator=(OSSharedBuf xOther)
+    {
+        // Argument is already a copy, its destructor drops the old reference
+        os_shared_buf_t* pxBuf = m_pxBuf;
+        m_pxBuf = xOther.m_pxBuf;
+        xOther.m_pxBuf = pxBuf;
+        return *this;
+    }
+
+    ~OSSharedBuf()
+    {
+        reset();
+    };
+
+    /**
+     * @brief Drop the reference, buffer is freed if it was the last one
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE void reset(void)
+    {
+        os_shared_buf_t* pxBuf = m_pxBuf;
+        m_pxBuf = nullptr;
+
+        if ((pxBuf != nullptr) && (pxBuf->uxRefs.fetchSub(1u) == 1u)) {
+            pxBuf->pxPool->_free(pxBuf);
+        }
+    }
+
+    /**
+     * @brief Take over a raw reference
+     *
+     * @param pxBuf Reference returned by @ref share() or @ref detach()
+     */
+    void attach(os_shared_buf_t* pxBuf)
+    {
+        reset();
+        m_pxBuf = pxBuf;
+    }
+
+    /**
+     * @brief Get one more raw reference, e.g. to send it to a Queue
+     *
+     * @retval Reference which must be taken over by exactly one receiver
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE os_shared_buf_t* share(void) const
+    {
+        if (m_pxBuf != nullptr) {
+            m_pxBuf->uxRefs.fetchAdd(1u);
+        }
+        return m_pxBuf;
+    }
+
+    /**
+     * @brief Give up this reference without dropping it
+     *
+     * @retval Raw reference, nullptr if handle was empty
+     */
+    os_shared_buf_t* detach(void)
+    {
+        os_shared_buf_t* pxBuf = m_pxBuf;
+        m_pxBuf = nullptr;
+        return pxBuf;
+    }
+
+    /**
+     * @brief Get read-only content
+     */
+    const uint8_t* getData(void) const
+    {
+        return (m_pxBuf != nullptr) ? m_pxBuf->pucData : nullptr;
+    }
+
+    /**
+     * @brief Get content to fill it
+     *
+     * @retval Pointer to the data, nullptr if buffer is already shared
+     */
+    uint8_t* getWritable(void)
+    {
+        if ((m_pxBuf == nullptr) || (m_pxBuf->uxRefs.load() != 1u)) {
+            return nullptr;
+        }
+        return m_pxBuf->pucData;
+    }
+
+    /**
+     * @brief Set amount of valid bytes
+     *
+     * @param uxLength Amount of bytes, not more than capacity
+     *
+     * @return "true" if successful, "false" if buffer is already shared
+     */
+    bool setLength(uint32_t uxLength)
+    {
+        assert((m_pxBuf == nullptr) || (uxLength <= m_pxBuf->pxPool->getCapacity()));
+        if ((getWritable() == nullptr) || (uxLength > m_pxBuf->pxPool->getCapacity())) {
+            return false;
+        }
+
+        m_pxBuf->uxLength = uxLength;
+        return true;
+    }
+
+    /**
+     * @brief Get amount of valid bytes
+     */
+    uint32_t getLength(void) const
+    {
+        return (m_pxBuf != nullptr) ? m_pxBuf->uxLength : 0u;
+    }
+
+    /**
+     * @brief Get amount of references
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getRefCount(void) const
+    {
+        return (m_pxBuf != nullptr) ? m_pxBuf->uxRefs.load() : 0u;
+    }
+
+    /**
+     * @brief Check if handle refers to a buffer
+     */
+    bool isValid(void) const
+    {
+        return (m_pxBuf != nullptr);
+    }
+};
+
+
+/**
+ * @brief Static pool of reference counted buffers
+ *
+ * One payload is handed to many consumers as N pointer sends
+ * instead of N copies. It goes back to the pool when the last one drops it.
+ *
+ * @code{cpp}
+ * OSSharedBufPool<1024, 4> Frames;
+ * OSQueue<4, os_shared_buf_t*> toDisplay, toLogger;
+ * ...
+ * // Producer
+ * OSSharedBuf frame = Frames.alloc(pixels, sizeof(pixels));
+ * os_shared_buf_t* pxRef = frame.share();
+ * if (!toDisplay.send(pxRef, 0)) {
+ *     OSSharedBuf lost;
+ *     lost.attach(pxRef); // not sent, so the sender drops it
+ *     lost.reset();
+ * }
+ * ... // same for toLogger
+ * // own reference is dropped here
+ * ...
+ * // Any consumer, Task or ISR
+ * os_shared_buf_t* pxRaw;
+ * toLogger.receive(pxRaw);
+ * OSSharedBuf frame(pxRaw);
+ * log(frame.getData(), frame.getLength());
+ * @endcode
+ *
+ * @tparam Size Size of every buffer in bytes
+ * @tparam Count Amount of buffers
+ *
+ * @note This class is thread-safe, multi-core safe and an ISR safe
+ */
+template <uint32_t Size, uint32_t Count>
+class OSSharedBufPool : public OSSharedBufPoolBase
+{
+    static_assert(Size != 0u, "Size must not be 0");
+    static_assert((Count != 0u) && (Count <= OS_LOCK_FREE_STACK_MAX), "Count must be 1..OS_LOCK_FREE_STACK_MAX");
+
+private:
+    static constexpr uint32_t Stride = (Size + OS_SHARED_BUF_ALIGN - 1u) & ~(uint32_t)(OS_SHARED_BUF_ALIGN - 1u);
+
+    os_shared_buf_t m_xBufs[Count];
+    alignas(OS_SHARED_BUF_ALIGN) uint8_t m_ucData[Stride * Count];
+    OSAtomic<uint32_t> m_uxLinks[Count];
+
+public:
+    OSSharedBufPool() : OSSharedBufPoolBase(m_xBufs, m_uxLinks, Count, Size)
+    {
+        _reset(m_ucData, Stride, Count);
+    };
+
+    /**
+     * @brief Take a free buffer
+     *
+     * @retval Unique reference, empty if pool is exhausted
+     *
+     * @note This method is an ISR safe
+     */
+    OS_HOT_INLINE OSSharedBuf alloc(void)
+    {
+        return OSSharedBuf(_alloc());
+    }
+
+    /**
+     * @brief Take a free buffer and copy the data into it
+     *
+     * @param pvData Data to copy
+     * @param uxSize Amount of bytes, not more than Size
+     *
+     * @retval Unique reference, empty if pool is exhausted or data is too big
+     *
+     * @note This method is an ISR safe
+     */
+    OSSharedBuf alloc(const void* pvData, uint32_t uxSize)
+    {
+        assert(uxSize <= Size);
+        if (uxSize > Size) {
+            return OSSharedBuf();
+        }
+
+        OSSharedBuf xBuf(_alloc());
+        if (xBuf.isValid()) {
+            memcpy(xBuf.getWritable(), pvData, uxSize);
+            xBuf.setLength(uxSize);
+        }
+        return xBuf;
+    }
+
+    /**
+     * @brief Get amount of buffers
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return Count;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_SHARED_BUF_HPP
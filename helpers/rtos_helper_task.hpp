@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -46,29 +49,24 @@
 
 
 /**
- * @brief Template class for Task creation and manipulation
+ * @brief Common part of every @ref OSTask, not depending on stack size
+ *
+ * All the logic lives here, so it's compiled only once
+ * no matter how many different stack sizes are used.
+ * Use pointer or reference to it to pass any Task object around:
  *
  * @code{cpp}
- * // Create task and provide 400 words for stack.
- * OSTask <2048u>AppMainTask(vAppMainTask, "AppMainTask");
+ * OSTask <768> AppTask(vAppTask, "AppTask", &AppTask);
  * ...
+ * void vAppTask(void* pvArg)
  * {
- *     ...
- *     // Call an actual OS Task creation
- *     AppMainTask.init();
+ *     auto self = reinterpret_cast<OSTaskBase*>(pvArg);
+ *     self->waitSignal();
  *     ...
  * }
  * @endcode
- * 
- * In case of multi-core MCU use this construction:
- * 
- * @code{cpp}
- * // Create task on CPU0 ( PRO_CPU for ESP32) and provide 4096 words for it.
- * OSTask <4096u>AppMainTask(vAppMainTask, "AppMainTask", nullptr, SomeTaskPriority, OS_MCU_CORE_0);
- * @endcode
  */
-template <uint32_t TStackSize>
-class OSTask
+class OSTaskBase
 {
 private:
     // Pointer to callback function with Main code containing endless loop
@@ -79,14 +77,14 @@ private:
     void* m_TaskArgument = nullptr;
     // How much time OS scheduler will provide to this Thread/Task
     UBaseType_t m_TaskPriority = tskIDLE_PRIORITY;
-    // Number of Pinned MCU core (only used if MCU has multiple cores!)
-    os_mcu_core_num_t m_ePinnedCore = OS_MCU_CORE_NONE;
+    // Set of MCU cores allowed to run the Task (only used if MCU has multiple cores!)
+    os_mcu_core_mask_t m_uxCoreMask = OS_MCU_CORE_MASK_ANY;
 
     // An OS object handler.
     TaskHandle_t m_TaskHandle = nullptr;
     
     // Amount of physical RAM provided to the Thread/Task in words
-    uint32_t m_TaskStackSize = TStackSize;
+    uint32_t m_TaskStackSize = 0u;
     
     // Required only for @ref SyncWait to use monotonic time with exact execution time 
     TickType_t m_xLastWakeTime = 0u;
@@ -97,21 +95,54 @@ private:
 #if (configSUPPORT_STATIC_ALLOCATION == 1)
     // Lines below are OS specific data in RAM created and located at compile time.
     StaticTask_t m_xTaskControlBlock;
-    StackType_t m_xTaskStack[TStackSize];
+    // Points to the stack storage located in @ref OSTask
+    StackType_t* m_pxTaskStack = nullptr;
 #endif // configSUPPORT_STATIC_ALLOCATION
 
+#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+    // Single core out of the mask, or OS_MCU_CORE_NONE if mask allows several cores
+    static os_mcu_core_num_t _maskToCore(os_mcu_core_mask_t uxCoreMask)
+    {
+        if ((uxCoreMask == 0u) || ((uxCoreMask & (uxCoreMask - 1u)) != 0u)) {
+            return OS_MCU_CORE_NONE;
+        }
+
+        uint32_t core = 0u;
+        while ((uxCoreMask >>= 1u) != 0u) {
+            core++;
+        }
+        return (core < OS_MCU_CORE_NONE) ? (os_mcu_core_num_t)core : OS_MCU_CORE_NONE;
+    }
+#endif // OS_MCU_ENABLE_MULTICORE_SUPPORT
 
-public:
-    OSTask(void (*TaskFuncPtr)(void*),
-                        const char* TaskName, void* TaskArgument = nullptr, 
-                        uint32_t TaskPriority = tskIDLE_PRIORITY,
-                        os_mcu_core_num_t ePinnedCore = OS_MCU_CORE_NONE)
+protected:
+    // Convert legacy single core selection into the mask
+    static constexpr os_mcu_core_mask_t _coreToMask(os_mcu_core_num_t ePinnedCore)
+    {
+        return (ePinnedCore < OS_MCU_CORE_NONE) ? OS_MCU_CORE_MASK(ePinnedCore) : OS_MCU_CORE_MASK_ANY;
+    }
+
+    // Only @ref OSTask is allowed to create it, as it holds the stack
+    OSTaskBase(void (*TaskFuncPtr)(void*),
+                        const char* TaskName, void* TaskArgument,
+                        uint32_t TaskPriority,
+                        os_mcu_core_mask_t uxCoreMask,
+                        StackType_t* pxTaskStack, uint32_t TaskStackSize)
                                 : m_TaskFuncPtr(TaskFuncPtr), 
                                 m_TaskName(TaskName), m_TaskArgument(TaskArgument),
                                 m_TaskPriority(TaskPriority),
-                                m_ePinnedCore(ePinnedCore) {};
+                                m_uxCoreMask(uxCoreMask),
+                                m_TaskStackSize(TaskStackSize)
+    {
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        m_pxTaskStack = pxTaskStack;
+#else
+        (void)pxTaskStack;
+#endif
+    };
 
-    ~OSTask()
+    // Not virtual, so it's protected: Task must be destroyed only through it's real type
+    ~OSTaskBase()
     {
 #if (INCLUDE_vTaskDelete == 1)
         assert(m_TaskHandle);
@@ -124,7 +155,7 @@ public:
 #endif
     }
 
-
+public:
     /**
      * @brief Create software Thread/Task with OS functions
      * 
@@ -141,38 +172,62 @@ public:
         assert(m_TaskFuncPtr != nullptr);
         assert(m_TaskStackSize != 0u);
 
-#ifdef OS_MCU_ENABLE_MULTICORE_SUPPORT
+#if defined(OS_MCU_ENABLE_AFFINITY_MASK)
 #if configSUPPORT_STATIC_ALLOCATION
-        if (m_ePinnedCore < OS_MCU_CORE_NONE) {
+        if (m_uxCoreMask != OS_MCU_CORE_MASK_ANY) {
+          m_TaskHandle = xTaskCreateStaticAffinitySet(
+              static_cast<TaskFunction_t>(m_TaskFuncPtr), m_TaskName,
+              m_TaskStackSize, m_TaskArgument, m_TaskPriority, m_pxTaskStack,
+              &m_xTaskControlBlock, m_uxCoreMask);
+        } else {
+          m_TaskHandle = xTaskCreateStatic(static_cast<TaskFunction_t>(m_TaskFuncPtr),
+                                      m_TaskName, m_TaskStackSize, m_TaskArgument,
+                                      m_TaskPriority, m_pxTaskStack, &m_xTaskControlBlock);
+        }
+#else
+        if (m_uxCoreMask != OS_MCU_CORE_MASK_ANY) {
+          xTaskCreateAffinitySet(static_cast<TaskFunction_t>(m_TaskFuncPtr),
+                                 m_TaskName, m_TaskStackSize, m_TaskArgument,
+                                 m_TaskPriority, m_uxCoreMask, &m_TaskHandle);
+        } else {
+          xTaskCreate(static_cast<TaskFunction_t>(m_TaskFuncPtr), m_TaskName,
+                      m_TaskStackSize, m_TaskArgument, m_TaskPriority, &m_TaskHandle);
+        }
+#endif // configSUPPORT_STATIC_ALLOCATION
+#elif defined(OS_MCU_ENABLE_MULTICORE_SUPPORT)
+        // Kernel can pin Task only to a single core
+        os_mcu_core_num_t ePinnedCore = _maskToCore(m_uxCoreMask);
+#if configSUPPORT_STATIC_ALLOCATION
+        if (ePinnedCore < OS_MCU_CORE_NONE) {
           m_TaskHandle = xTaskCreateStaticPinnedToCore(
               static_cast<TaskFunction_t>(m_TaskFuncPtr), m_TaskName,
-              m_TaskStackSize, m_TaskArgument, m_TaskPriority, &m_xTaskStack[0],
-              &m_xTaskControlBlock, (BaseType_t)m_ePinnedCore);
+              m_TaskStackSize, m_TaskArgument, m_TaskPriority, m_pxTaskStack,
+              &m_xTaskControlBlock, (BaseType_t)ePinnedCore);
         } else {
           m_TaskHandle = xTaskCreateStatic(static_cast<TaskFunction_t>(m_TaskFuncPtr),
                                       m_TaskName, m_TaskStackSize, m_TaskArgument,
-                                      m_TaskPriority, &m_xTaskStack[0], &m_xTaskControlBlock);
+                                      m_TaskPriority, m_pxTaskStack, &m_xTaskControlBlock);
         }
 #else
-        if (m_ePinnedCore < OS_MCU_CORE_NONE) {
+        if (ePinnedCore < OS_MCU_CORE_NONE) {
           xTaskCreatePinnedToCore(static_cast<TaskFunction_t>(m_TaskFuncPtr),
                                   m_TaskName, m_TaskStackSize, m_TaskArgument,
-                                  m_TaskPriority, &m_xTask, (BaseType_t)m_ePinnedCore);
+                                  m_TaskPriority, &m_TaskHandle, (BaseType_t)ePinnedCore);
         } else {
           xTaskCreate(static_cast<TaskFunction_t>(m_TaskFuncPtr), m_TaskName,
-                      m_TaskStackSize, m_TaskArgument, m_TaskPriority, &m_xTask);
+                      m_TaskStackSize, m_TaskArgument, m_TaskPriority, &m_TaskHandle);
         }
 #endif // configSUPPORT_STATIC_ALLOCATION
 #else
 #if configSUPPORT_STATIC_ALLOCATION
         m_TaskHandle = xTaskCreateStatic(static_cast<TaskFunction_t>(m_TaskFuncPtr),
                                 m_TaskName, m_TaskStackSize, m_TaskArgument,
-                                m_TaskPriority, &m_xTaskStack[0], &m_xTaskControlBlock);
+                                m_TaskPriority, m_pxTaskStack, &m_xTaskControlBlock);
 #else
         xTaskCreate(static_cast<TaskFunction_t>(m_TaskFuncPtr), m_TaskName,
                     m_TaskStackSize, m_TaskArgument, m_TaskPriority, &m_TaskHandle);
 #endif
-#endif // OS_MCU_ENABLE_MULTICORE_SUPPORT
+#endif // OS_MCU_ENABLE_AFFINITY_MASK
         assert(m_TaskHandle);
         if (m_TaskHandle != nullptr) {
             m_initialized = true;
@@ -293,6 +348,66 @@ public:
         return m_TaskArgument;
     }
 
+    /**
+     * @brief Sets the set of cores allowed to run the Task
+     * 
+     * @param uxCoreMask Bit N allows core N, e.g. OS_MCU_CORE_MASK(0) | OS_MCU_CORE_MASK(2),
+     *                   OS_MCU_CORE_MASK_ANY lets the scheduler pick any core
+     * 
+     * @return "true" if successful, "false" if it can't be changed
+     * 
+     * @note 1. Before @ref init() mask is only stored and used at Task creation.
+     * @note 2. After @ref init() requires SMP kernel with configUSE_CORE_AFFINITY,
+     *          otherwise Task stays where it was created.
+     * @note 3. Without SMP affinity support only a single core or OS_MCU_CORE_MASK_ANY
+     *          are honoured at creation.
+     */
+    bool setAffinity(os_mcu_core_mask_t uxCoreMask)
+    {
+        assert(uxCoreMask != 0u);
+        if (uxCoreMask == 0u) {
+            return false;
+        }
+
+        if (!m_initialized) {
+            m_uxCoreMask = uxCoreMask;
+            return true;
+        }
+
+#ifdef OS_MCU_ENABLE_AFFINITY_MASK
+        vTaskCoreAffinitySet(m_TaskHandle, uxCoreMask);
+        m_uxCoreMask = uxCoreMask;
+        return true;
+#else
+        return false;
+#endif // OS_MCU_ENABLE_AFFINITY_MASK
+    }
+
+    /**
+     * @brief Get the set of cores allowed to run the Task
+     * 
+     * @retval Core mask, OS_MCU_CORE_MASK_ANY if Task is not pinned
+     */
+    os_mcu_core_mask_t getAffinity(void)
+    {
+#ifdef OS_MCU_ENABLE_AFFINITY_MASK
+        if (m_initialized) {
+            return vTaskCoreAffinityGet(m_TaskHandle);
+        }
+#endif // OS_MCU_ENABLE_AFFINITY_MASK
+        return m_uxCoreMask;
+    }
+
+    /**
+     * @brief Get the priority given to the Task on creation
+     *
+     * @retval Base priority, not affected by inheritance or donation
+     */
+    UBaseType_t getPriority(void)
+    {
+        return m_TaskPriority;
+    }
+
 
 #if (INCLUDE_vTaskSuspend == 1)
     /**
@@ -325,7 +440,7 @@ public:
      * 
      * @note requires INCLUDE_vTaskResume to be 1
      */
-    bool start(void)
+    OS_HOT_SECTION bool start(void)
     {
         assert(m_TaskHandle);
         assert(m_initialized == true);
@@ -334,22 +449,24 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             vTaskResume(m_TaskHandle);
             return true;
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             *status = xTaskResumeFromISR(m_TaskHandle);
             yieldFunc(status);
             return true;
         });
 #else
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       vTaskResume(m_TaskHandle);
     } else {
       BaseType_t xHigherPriorityStatus = xTaskResumeFromISR(m_TaskHandle);
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
@@ -370,7 +487,7 @@ public:
      * @note 1. This method can be used in any task, even by task itself!
      * @note 2. Requires configUSE_TASK_NOTIFICATIONS to be 1
      */
-    bool emitSignal(void)
+    OS_HOT_SECTION bool emitSignal(void)
     {
         assert(m_TaskHandle);
         assert(m_initialized == true);
@@ -379,23 +496,25 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xTaskNotifyGive(m_TaskHandle);
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             vTaskNotifyGiveFromISR(m_TaskHandle, status);
             yieldFunc(status);
             return true;
         });
 #else
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       return xTaskNotifyGive(m_TaskHandle);
     } else {
       BaseType_t xHigherPriorityStatus = pdFALSE;
       vTaskNotifyGiveFromISR(m_TaskHandle, &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
 
       return true;
@@ -428,6 +547,8 @@ public:
 #warning "INCLUDE_xTaskGetCurrentTaskHandle is not enabled! Using .waitSignal() is not thread safe!"
 #endif // INCLUDE_xTaskGetCurrentTaskHandle
 
+        OS_HELPER_SCHED_POINT();
+
         do {
             portNOP();
         } while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(xMsToWait)) == pdFALSE);
@@ -510,9 +631,11 @@ public:
      * 
      * @param xMsToWait How much time to wait in milliseconds for next Sync
      * 
+     * @return "true" if Task was blocked, "false" if next Sync time has already passed
+     * 
      * @note Must be called inside of Task's loop code !
      */
-    void syncWait(size_t xMsToWait = portMAX_DELAY_MS)
+    bool syncWait(size_t xMsToWait = portMAX_DELAY_MS)
     {
         // assert(INCLUDE_xTaskGetCurrentTaskHandle == 1);
         assert(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
@@ -524,7 +647,7 @@ public:
 #warning "INCLUDE_xTaskGetCurrentTaskHandle is not enabled! Using .syncWait() is not thread safe!"
 #endif // INCLUDE_xTaskGetCurrentTaskHandle
 
-        xTaskDelayUntil(&m_xLastWakeTime, pdMS_TO_TICKS(xMsToWait));
+        return (xTaskDelayUntil(&m_xLastWakeTime, pdMS_TO_TICKS(xMsToWait)) == pdTRUE);
     }
 
     /**
@@ -562,6 +685,77 @@ public:
     }
 };
 
+
+/**
+ * @brief Template class for Task creation and manipulation
+ *
+ * Holds only the stack, see @ref OSTaskBase for all methods.
+ *
+ * @code{cpp}
+ * // Create task and provide 400 words for stack.
+ * OSTask <2048u>AppMainTask(vAppMainTask, "AppMainTask");
+ * ...
+ * {
+ *     ...
+ *     // Call an actual OS Task creation
+ *     AppMainTask.init();
+ *     ...
+ * }
+ * @endcode
+ * 
+ * In case of multi-core MCU use this construction:
+ * 
+ * @code{cpp}
+ * // Create task on CPU0 ( PRO_CPU for ESP32) and provide 4096 words for it.
+ * OSTask <4096u>AppMainTask(vAppMainTask, "AppMainTask", nullptr, SomeTaskPriority, OS_MCU_CORE_0);
+ * @endcode
+ * 
+ * On SMP kernel with more cores use a mask of allowed cores instead:
+ * 
+ * @code{cpp}
+ * OSTask <4096u>AppMainTask(vAppMainTask, "AppMainTask", nullptr, SomeTaskPriority,
+ *                           OS_MCU_CORE_MASK(2) | OS_MCU_CORE_MASK(3));
+ * @endcode
+ */
+template <uint32_t TStackSize>
+class OSTask : public OSTaskBase
+{
+private:
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    // Stack of the Thread/Task created and located at compile time.
+    StackType_t m_xTaskStack[TStackSize];
+#endif // configSUPPORT_STATIC_ALLOCATION
+
+public:
+    OSTask(void (*TaskFuncPtr)(void*),
+                        const char* TaskName, void* TaskArgument = nullptr, 
+                        uint32_t TaskPriority = tskIDLE_PRIORITY,
+                        os_mcu_core_num_t ePinnedCore = OS_MCU_CORE_NONE)
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+                                : OSTaskBase(TaskFuncPtr, TaskName, TaskArgument,
+                                            TaskPriority, _coreToMask(ePinnedCore),
+                                            m_xTaskStack, TStackSize) {};
+#else
+                                : OSTaskBase(TaskFuncPtr, TaskName, TaskArgument,
+                                            TaskPriority, _coreToMask(ePinnedCore),
+                                            nullptr, TStackSize) {};
+#endif
+
+    OSTask(void (*TaskFuncPtr)(void*),
+                        const char* TaskName, void* TaskArgument,
+                        uint32_t TaskPriority,
+                        os_mcu_core_mask_t uxCoreMask)
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+                                : OSTaskBase(TaskFuncPtr, TaskName, TaskArgument,
+                                            TaskPriority, uxCoreMask,
+                                            m_xTaskStack, TStackSize) {};
+#else
+                                : OSTaskBase(TaskFuncPtr, TaskName, TaskArgument,
+                                            TaskPriority, uxCoreMask,
+                                            nullptr, TStackSize) {};
+#endif
+};
+
 // - - - - - - - - - - - - - - - - - - - - - - - -
 
 
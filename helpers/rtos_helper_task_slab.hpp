@@ -0,0 +1,266 @@
+/**
+ * @file rtos_helper_task_slab.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_TASK_SLAB_HPP
+#define _RTOS_HELPER_TASK_SLAB_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+#include "rtos_helper_atomic.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Name of spawned Tasks if none is given
+#ifndef OS_TASK_SLAB_DEFAULT_NAME
+#define OS_TASK_SLAB_DEFAULT_NAME "slab"
+#endif // OS_TASK_SLAB_DEFAULT_NAME
+
+// Life cycle of a slot
+typedef enum {
+  OS_TASK_SLOT_FREE = 0UL, // Ready to spawn
+  OS_TASK_SLOT_CLAIMED,    // Taken by spawn() or reclaim in progress
+  OS_TASK_SLOT_RUNNING,    // Task function is executed
+  OS_TASK_SLOT_EXITED      // Task function returned, Task suspends itself
+} os_task_slot_state_t;
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+#if ((configSUPPORT_STATIC_ALLOCATION == 1) && (INCLUDE_vTaskDelete == 1) && \
+     (INCLUDE_vTaskSuspend == 1) && (INCLUDE_eTaskGetState == 1))
+/**
+ * @brief Preallocated pool of stacks and TCBs for short-lived Tasks
+ *
+ * Every spawn() creates a real FreeRTOS Task with xTaskCreateStatic()
+ * in a free slot, so there is no heap and no fragmentation.
+ * Task function simply returns when done, slot is reclaimed automatically
+ * by the next spawn().
+ *
+ * @code{cpp}
+ * OSTaskSlab<4, 4096> Jobs;
+ * ...
+ * void vUploadJob(void* pvArg)
+ * {
+ *     upload(static_cast<Chunk*>(pvArg));
+ *     // just return, no selfDelete() needed
+ * }
+ * ...
+ * if (Jobs.spawn(vUploadJob, &chunk, tskIDLE_PRIORITY + 1) == nullptr) {
+ *     // all slots are busy
+ * }
+ * @endcode
+ *
+ * @tparam Count Amount of slots
+ * @tparam StackSize Stack of every slot, same units as OSTask
+ *
+ * @note 1. Returned Task is suspended (not deleted) right after its function,
+ *          deleting a Task from its own code would leave TCB to the Idle Task,
+ *          so slot could not be reused at once.
+ * @note 2. spawn() is NOT an ISR safe.
+ */
+template <uint32_t Count, uint32_t StackSize>
+class OSTaskSlab
+{
+    static_assert(Count != 0u, "Count must not be 0");
+
+private:
+    typedef struct {
+        OSAtomic<uint32_t> uxState;
+        TaskHandle_t volatile xHandle;
+        void (*pxFunc)(void*);
+        void* pvArg;
+        StaticTask_t xTaskControlBlock;
+        StackType_t xStack[StackSize];
+    } os_task_slot_t;
+
+    os_task_slot_t m_xSlots[Count];
+
+    // Entry of every spawned Task
+    static void _trampoline(void* pvSlot)
+    {
+        os_task_slot_t* pxSlot = static_cast<os_task_slot_t*>(pvSlot);
+        pxSlot->pxFunc(pxSlot->pvArg);
+
+        pxSlot->uxState.store(OS_TASK_SLOT_EXITED);
+        for (;;) {
+            vTaskSuspend(nullptr);
+        }
+    }
+
+    // Take the slot if it's free or holds an already suspended Task
+    bool _claim(os_task_slot_t& xSlot)
+    {
+        uint32_t uxExpected = OS_TASK_SLOT_FREE;
+        if (xSlot.uxState.compareExchange(uxExpected, OS_TASK_SLOT_CLAIMED)) {
+            return true;
+        }
+
+        // Task might still be between the store and vTaskSuspend(),
+        // or finish before spawn() got its handle
+        TaskHandle_t xHandle = xSlot.xHandle;
+        if ((uxExpected != OS_TASK_SLOT_EXITED) || (xHandle == nullptr) ||
+            (eTaskGetState(xHandle) != eSuspended)) {
+            return false;
+        }
+
+        if (!xSlot.uxState.compareExchange(uxExpected, OS_TASK_SLOT_CLAIMED)) {
+            return false;
+        }
+
+        // Not the running Task, so TCB and stack are released right here
+        vTaskDelete(xHandle);
+        xSlot.xHandle = nullptr;
+        return true;
+    }
+
+    static TaskHandle_t _create(os_task_slot_t& xSlot, const char* pcName,
+                                UBaseType_t uxPriority, os_mcu_core_mask_t uxCoreMask)
+    {
+#if defined(OS_MCU_ENABLE_AFFINITY_MASK)
+        if (uxCoreMask != OS_MCU_CORE_MASK_ANY) {
+            return xTaskCreateStaticAffinitySet(_trampoline, pcName, StackSize, &xSlot, uxPriority,
+                                                xSlot.xStack, &xSlot.xTaskControlBlock, uxCoreMask);
+        }
+#elif defined(OS_MCU_ENABLE_MULTICORE_SUPPORT)
+        // Kernel can pin Task only to a single core
+        if ((uxCoreMask != 0u) && ((uxCoreMask & (uxCoreMask - 1u)) == 0u)) {
+            return xTaskCreateStaticPinnedToCore(_trampoline, pcName, StackSize, &xSlot, uxPriority,
+                                                 xSlot.xStack, &xSlot.xTaskControlBlock,
+                                                 (BaseType_t)__builtin_ctz(uxCoreMask));
+        }
+#else
+        (void)uxCoreMask;
+#endif // OS_MCU_ENABLE_AFFINITY_MASK
+        return xTaskCreateStatic(_trampoline, pcName, StackSize, &xSlot, uxPriority,
+                                 xSlot.xStack, &xSlot.xTaskControlBlock);
+    }
+
+public:
+    OSTaskSlab()
+    {
+        for (uint32_t i = 0u; i < Count; i++) {
+            m_xSlots[i].uxState.store(OS_TASK_SLOT_FREE);
+            m_xSlots[i].xHandle = nullptr;
+        }
+    };
+
+    /**
+     * @brief Create a Task in a free slot
+     *
+     * @param pxFunc Task function, may simply return when done
+     * @param pvArg Argument of the function
+     * @param uxPriority Priority of the Task
+     * @param uxCoreMask Cores allowed to run the Task, see OS_MCU_CORE_MASK()
+     * @param pcName Name of the Task (required only for debug)
+     *
+     * @retval Handle of created Task, nullptr if all slots are busy
+     *
+     * @note This method is thread-safe, it takes bounded time with no heap
+     */
+    TaskHandle_t spawn(void (*pxFunc)(void*), void* pvArg = nullptr,
+                       UBaseType_t uxPriority = tskIDLE_PRIORITY,
+                       os_mcu_core_mask_t uxCoreMask = OS_MCU_CORE_MASK_ANY,
+                       const char* pcName = OS_TASK_SLAB_DEFAULT_NAME)
+    {
+        assert(pxFunc != nullptr);
+        if (pxFunc == nullptr) {
+            return nullptr;
+        }
+
+        for (uint32_t i = 0u; i < Count; i++) {
+            os_task_slot_t& xSlot = m_xSlots[i];
+            if (!_claim(xSlot)) {
+                continue;
+            }
+
+            xSlot.pxFunc = pxFunc;
+            xSlot.pvArg = pvArg;
+            // Set before creation, new Task may finish before xTaskCreateStatic() returns
+            xSlot.uxState.store(OS_TASK_SLOT_RUNNING);
+
+            TaskHandle_t xHandle = _create(xSlot, pcName, uxPriority, uxCoreMask);
+            assert(xHandle);
+            if (xHandle == nullptr) {
+                xSlot.uxState.store(OS_TASK_SLOT_FREE);
+                return nullptr;
+            }
+
+            xSlot.xHandle = xHandle;
+            return xHandle;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Get amount of slots which can be used by spawn()
+     *
+     * @note Only a hint, might be outdated right after return
+     */
+    uint32_t getFreeCount(void)
+    {
+        uint32_t uxFree = 0u;
+
+        for (uint32_t i = 0u; i < Count; i++) {
+            uint32_t uxState = m_xSlots[i].uxState.load();
+            if ((uxState == OS_TASK_SLOT_FREE) || (uxState == OS_TASK_SLOT_EXITED)) {
+                uxFree++;
+            }
+        }
+
+        return uxFree;
+    }
+
+    /**
+     * @brief Get amount of slots
+     */
+    static constexpr uint32_t getSize(void)
+    {
+        return Count;
+    }
+};
+#endif // configSUPPORT_STATIC_ALLOCATION && INCLUDE_vTaskDelete && INCLUDE_vTaskSuspend
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_TASK_SLAB_HPP
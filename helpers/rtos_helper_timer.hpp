@@ -16,6 +16,9 @@
 
 #if defined(ARDUINO)
 #include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "timers.h"
 #else
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -67,6 +70,18 @@
  * ...
  * @endcode
  * 
+ * For inactivity timeouts kicked very often use lazy restart mode:
+ *
+ * @code{cpp}
+ * OSTimer linkLostTimer(linkLostTimerFunc, "linkLostTimer");
+ * ...
+ * linkLostTimer.setLazyRestart(true);
+ * linkLostTimer.init();
+ * ...
+ * // On every received packet, costs only a deadline update
+ * linkLostTimer.restart(1000u);
+ * @endcode
+ *
  * @note Callback function for the Timer SHOULD NOT block/pause/delay/suspend code execution
  *       (it will break Timers and OS scheduler) !
  */
@@ -88,11 +103,76 @@ private:
     // Status flag showing if @ref init() was done with success
     bool m_initialized = false;
 
+    // Status flag telling @ref restart() to only move deadline forward
+    bool m_lazyRestart = false;
+    // Set while OS Timer is armed in lazy mode
+    volatile bool m_lazyArmed = false;
+    // Set by @ref stop(), only user calls clear it, never the callback
+    volatile bool m_lazyStopped = false;
+    // Absolute time in ticks when callback must be called in lazy mode
+    volatile TickType_t m_xLazyDeadline = 0u;
+    // Last period in ticks used in lazy mode
+    volatile TickType_t m_xLazyPeriod = 0u;
+
 #if (configSUPPORT_STATIC_ALLOCATION == 1)
     // Lines below are OS specific data in RAM created and located at compile time.
     StaticTimer_t m_xTimerHandlerControlBlock;
 #endif
 
+    OS_HOT_SECTION static TickType_t _getTickCount()
+    {
+        return (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) ? xTaskGetTickCount() : xTaskGetTickCountFromISR();
+    }
+
+    // Ticks left until lazy deadline, or zero if it has been reached
+    TickType_t _lazyRemaining()
+    {
+        TickType_t xRemaining = m_xLazyDeadline - xTaskGetTickCount();
+        // Passed deadline wraps into a value bigger than any period
+        return ((xRemaining != 0u) && (xRemaining <= m_xLazyPeriod)) ? xRemaining : 0u;
+    }
+
+    // Called by the Timer Service Task instead of the user callback in lazy mode.
+    // If deadline was moved by @ref restart() meanwhile, it just re-arms OS Timer
+    // for the remaining time, otherwise calls user callback.
+    static void _lazyCallback(TimerHandle_t xTimer)
+    {
+        auto self = static_cast<OSTimer*>(pvTimerGetTimerID(xTimer));
+        assert(self);
+
+        // Stop command of stop() might be queued before re-arming below,
+        // which then restarts OS Timer: such late shot is dropped.
+        if (self->m_lazyStopped) {
+            return;
+        }
+
+        TickType_t xRemaining = self->_lazyRemaining();
+        if (xRemaining == 0u) {
+            self->m_lazyArmed = false;
+            // Pairs with fence in restart(): either restart() sees disarmed Timer
+            // and arms it by itself, or new deadline is visible right here.
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            xRemaining = self->_lazyRemaining();
+            if (xRemaining == 0u) {
+                self->m_TimerFuncPtr(xTimer);
+                return;
+            }
+            self->m_lazyArmed = true;
+        }
+
+        // Pairs with fence in stop(): don't re-arm what is already stopped
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (self->m_lazyStopped) {
+            return;
+        }
+
+        if (xTimerChangePeriod(xTimer, xRemaining, 0u) != pdPASS) {
+            // Command queue is full and only this Task drains it, so retry is useless.
+            // Left disarmed, next restart() does a real start.
+            self->m_lazyArmed = false;
+        }
+    }
+
 public:
     OSTimer(void (*callbackFunction)(TimerHandle_t),
             const char* timerName,
@@ -122,16 +202,20 @@ public:
         assert(m_TimerName != nullptr);
         assert(m_TimerFuncPtr != nullptr);
 
+        // In lazy mode OS Timer calls @ref _lazyCallback() which needs this object
+        void* pvTimerID = m_lazyRestart ? reinterpret_cast<void*>(this) : m_pvTimerID;
+        auto xCallback = m_lazyRestart ? _lazyCallback : static_cast<TimerCallbackFunction_t>(m_TimerFuncPtr);
+
 #if (configSUPPORT_STATIC_ALLOCATION == 1)
             m_xTimerHandler = xTimerCreateStatic(
-                        m_TimerName, 1, m_uxAutoReload, m_pvTimerID,
-                        static_cast<TimerCallbackFunction_t>(m_TimerFuncPtr),
+                        m_TimerName, 1, m_uxAutoReload, pvTimerID,
+                        xCallback,
                         &m_xTimerHandlerControlBlock);
 #else
 
             m_xTimerHandler = xTimerCreate(
-                        m_TimerName, 1, m_uxAutoReload, m_pvTimerID,
-                        static_cast<TimerCallbackFunction_t>(m_TimerFuncPtr));
+                        m_TimerName, 1, m_uxAutoReload, pvTimerID,
+                        xCallback);
 #endif
         assert(m_xTimerHandler);
         if (m_xTimerHandler != nullptr) {
@@ -187,6 +271,46 @@ public:
         return m_TimerName;
     }
 
+    /**
+     * @brief Enable lazy restart mode for inactivity timeouts
+     * 
+     * @param enable "true" to make @ref restart() only move deadline forward
+     * 
+     * @return "true" if successful, "false" IF IT WAS initialised or Timer is auto reload
+     * 
+     * @note 1. It's possible ONLY when @ref init() was NOT DONE!
+     * @note 2. In this mode @ref restart() does not post any command to the Timer Service Task
+     *          while Timer is running. When Timer fires it re-arms itself for the remaining time,
+     *          so user callback is called only when deadline is really reached.
+     *          If Timer command queue is full at that moment, Timer is left disarmed
+     *          and the next @ref restart() arms it again.
+     *          @ref stop() may race with such re-arm and OS Timer may fire once more,
+     *          that shot is dropped, user callback is never called after @ref stop().
+     * @note 3. In this mode pvTimerGetTimerID() returns pointer to this object,
+     *          use @ref getTimerID() to get timerID passed to the constructor.
+    */
+    bool setLazyRestart(bool enable)
+    {
+        assert(m_initialized == false);
+        assert((enable == false) || (m_uxAutoReload == false));
+        if (m_initialized || (enable && m_uxAutoReload)) {
+            return false;
+        }
+
+        m_lazyRestart = enable;
+        return true;
+    }
+
+    /**
+     * @brief Get timerID passed to the constructor
+     * 
+     * @retval Pointer to the user argument
+    */
+    void* getTimerID(void)
+    {
+        return m_pvTimerID;
+    }
+
     /**
      * @brief Star timer with provided time
      * 
@@ -197,7 +321,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool start(size_t xPeriodInMs = 0u)
+    OS_HOT_SECTION bool start(size_t xPeriodInMs = 0u)
     {
         assert(m_xTimerHandler);
         assert(m_initialized == true);
@@ -206,11 +330,20 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
+        if (m_lazyRestart) {
+            m_xLazyPeriod = pdMS_TO_TICKS(xPeriodInMs);
+            m_xLazyDeadline = _getTickCount() + m_xLazyPeriod;
+            m_lazyStopped = false;
+            m_lazyArmed = true;
+        }
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        BaseType_t res = execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             xTimerChangePeriod(m_xTimerHandler, pdMS_TO_TICKS(xPeriodInMs), 0ul);
             return xTimerStart(m_xTimerHandler, 0ul);
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             xTimerChangePeriodFromISR(m_xTimerHandler, pdMS_TO_TICKS(xPeriodInMs), status);
             auto res = xTimerStartFromISR(m_xTimerHandler, status);
             yieldFunc(status);
@@ -220,7 +353,7 @@ public:
         BaseType_t res = pdFALSE;
         BaseType_t xHigherPriorityStatus = pdFALSE;
 
-        if (xPortInIsrContext() == pdFALSE) {
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
           xTimerChangePeriod(m_xTimerHandler, pdMS_TO_TICKS(xPeriodInMs), 0UL);
           res = xTimerStart(m_xTimerHandler, 0UL);
         } else {
@@ -229,12 +362,16 @@ public:
           res = xTimerStartFromISR(m_xTimerHandler, &xHigherPriorityStatus);
 
           if (pdTRUE == xHigherPriorityStatus) {
-            portYIELD_FROM_ISR();
+            OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
           }
         }
+#endif
+        if (m_lazyRestart && (res != pdPASS)) {
+            // Command queue is full, so nothing is armed
+            m_lazyArmed = false;
+        }
 
         return (bool)res;
-#endif
     }
 
     /**
@@ -245,7 +382,7 @@ public:
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
     */
-    bool stop()
+    OS_HOT_SECTION bool stop()
     {
         assert(m_xTimerHandler);
         assert(m_initialized == true);
@@ -254,10 +391,17 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
+        m_lazyStopped = true;
+        m_lazyArmed = false;
+        // Pairs with fence in _lazyCallback()
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xTimerStop(m_xTimerHandler, 0ul);
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xTimerStopFromISR(m_xTimerHandler, status);
             yieldFunc(status);
             return res;
@@ -266,13 +410,13 @@ public:
         BaseType_t res = pdFALSE;
         BaseType_t xHigherPriorityStatus = pdFALSE;
 
-        if (xPortInIsrContext() == pdFALSE) {
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
           res = xTimerStop(m_xTimerHandler, 0UL);
         } else {
           res = xTimerStopFromISR(m_xTimerHandler, &xHigherPriorityStatus);
 
           if (pdTRUE == xHigherPriorityStatus) {
-            portYIELD_FROM_ISR();
+            OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
           }
         }
 
@@ -284,13 +428,16 @@ public:
      * @brief Restart timer with provided time (if already running)
      * 
      * @param xPeriodInMs Amount of time has to be passed before timer will shot.
+     *                    In lazy mode zero means to reuse last period.
      * 
-     * @return "true" if successful, "false" if not initialised
+     * @return "true" if successful, "false" if not initialised or Timer command queue is full
      * 
      * @note 1. This method is thread-safe
      * @note 2. This method is an ISR safe
+     * @note 3. In lazy mode it's just a deadline update while Timer is running,
+     *          see @ref setLazyRestart()
     */
-    bool restart(size_t xPeriodInMs = 0u)
+    OS_HOT_SECTION bool restart(size_t xPeriodInMs = 0u)
     {
         assert(m_xTimerHandler);
         assert(m_initialized == true);
@@ -299,10 +446,59 @@ public:
             return false;
         }
 
+        OS_HELPER_SCHED_POINT();
+
+        if (m_lazyRestart) {
+            if (xPeriodInMs != 0u) {
+                m_xLazyPeriod = pdMS_TO_TICKS(xPeriodInMs);
+            }
+            assert(m_xLazyPeriod != 0u);
+            m_xLazyDeadline = _getTickCount() + m_xLazyPeriod;
+
+            // Pairs with fence in _lazyCallback()
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            // Callback may leave it armed while stopped, stop() always wins
+            if (m_lazyArmed && !m_lazyStopped) {
+                return true;
+            }
+
+            // Not armed yet, just expired or stopped, so here is a real start
+            m_lazyStopped = false;
+            m_lazyArmed = true;
+#if (__cplusplus >= 201703L)
+            BaseType_t res = execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
+                return xTimerChangePeriod(m_xTimerHandler, m_xLazyPeriod, 0ul);
+            }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
+                auto res = xTimerChangePeriodFromISR(m_xTimerHandler, m_xLazyPeriod, status);
+                yieldFunc(status);
+                return res;
+            });
+#else
+            BaseType_t res = pdFALSE;
+            BaseType_t xHigherPriorityStatus = pdFALSE;
+
+            if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
+              res = xTimerChangePeriod(m_xTimerHandler, m_xLazyPeriod, 0UL);
+            } else {
+              res = xTimerChangePeriodFromISR(m_xTimerHandler, m_xLazyPeriod, &xHigherPriorityStatus);
+
+              if (pdTRUE == xHigherPriorityStatus) {
+                OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
+              }
+            }
+#endif
+            if (res != pdPASS) {
+                // Command queue is full, so nothing is armed
+                m_lazyArmed = false;
+            }
+
+            return (bool)res;
+        }
+
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xTimerReset(m_xTimerHandler, pdMS_TO_TICKS(xPeriodInMs));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xTimerResetFromISR(m_xTimerHandler, status);
             yieldFunc(status);
             return res;
@@ -311,13 +507,13 @@ public:
         BaseType_t res = pdFALSE;
         BaseType_t xHigherPriorityStatus = pdFALSE;
 
-        if (xPortInIsrContext() == pdFALSE) {
+        if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
           res = xTimerReset(m_xTimerHandler, pdMS_TO_TICKS(xPeriodInMs));
         } else {
           res = xTimerResetFromISR(m_xTimerHandler, &xHigherPriorityStatus);
 
           if (pdTRUE == xHigherPriorityStatus) {
-            portYIELD_FROM_ISR();
+            OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
           }
         }
 
@@ -379,7 +575,7 @@ public:
      * ...
      * @endcode
     */
-    static bool asyncCall(PendedFunction_t xFunctionToPend,
+    OS_HOT_SECTION static bool asyncCall(PendedFunction_t xFunctionToPend,
                             void* pvParameter1 = nullptr,
                             uint32_t ulParameter2 = 0u,
                             size_t xMsToWait = portMAX_DELAY_MS)
@@ -391,11 +587,11 @@ public:
         }
 
 #if (__cplusplus >= 201703L)
-        return (bool)execIsrFunc([&]() -> BaseType_t {
+        return (bool)execIsrFunc([&]() OS_HOT_INLINE -> BaseType_t {
             return xTimerPendFunctionCall(xFunctionToPend,
                                             pvParameter1, ulParameter2,
                                             pdMS_TO_TICKS(xMsToWait));
-        }, [&](auto status, auto yieldFunc) -> BaseType_t {
+        }, [&](auto status, auto yieldFunc) OS_HOT_INLINE -> BaseType_t {
             auto res = xTimerPendFunctionCallFromISR(xFunctionToPend,
                                                     pvParameter1, ulParameter2,
                                                     status);
@@ -405,7 +601,7 @@ public:
 #else
     BaseType_t res = pdFALSE;
 
-    if (xPortInIsrContext() == pdFALSE) {
+    if (OS_HELPER_IS_INSIDE_ISR() == pdFALSE) {
       res = xTimerPendFunctionCall(xFunctionToPend,
                                             pvParameter1, ulParameter2,
                                             pdMS_TO_TICKS(xMsToWait));
@@ -416,7 +612,7 @@ public:
                                                     &xHigherPriorityStatus);
 
       if (pdTRUE == xHigherPriorityStatus) {
-        portYIELD_FROM_ISR();
+        OS_HELPER_YIELD_FROM_ISR(xHigherPriorityStatus);
       }
     }
 
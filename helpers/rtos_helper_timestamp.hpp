@@ -0,0 +1,159 @@
+/**
+ * @file rtos_helper_timestamp.hpp
+ *
+ * Helpful API to make use of FreeRTOS a little easier.
+ * Supports both ESP-IDF and Arduino IDE.
+ *
+ * Author: Alexandr Antonov (@Bismuth208)
+ * Licence: MIT
+ *
+ * Minimal FreeRTOS version: v10.4.3
+ *
+ */
+
+#ifndef _RTOS_HELPER_TIMESTAMP_HPP
+#define _RTOS_HELPER_TIMESTAMP_HPP
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(OS_HELPER_VANILLA_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/FreeRTOSConfig.h"
+#include "freertos/task.h"
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#if defined(OS_HELPER_VANILLA_FREERTOS) && defined(__unix__)
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+
+// clang-format off
+
+#include "rtos_helper_core.hpp"
+
+/* -------------------------------------------------------------- */
+/* -------------------- Definitions ------------------------ */
+/* -------------------------------------------------------------- */
+
+// Select source of timestamps:
+//  - CPU cycle counter on Xtensa and Cortex-M3+ (DWT);
+//  - clock_gettime() in host builds;
+//  - OS ticks as a last resort.
+#if defined(__XTENSA__)
+#define OS_TIMESTAMP_USE_CCOUNT
+#elif (defined(ESP32) || defined(ESP_PLATFORM)) && defined(__riscv)
+#include "esp_cpu.h"
+#define OS_TIMESTAMP_USE_ESP_CPU
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define OS_TIMESTAMP_USE_DWT
+#elif defined(OS_HELPER_VANILLA_FREERTOS) && defined(__unix__)
+#define OS_TIMESTAMP_USE_CLOCK_GETTIME
+#else
+#define OS_TIMESTAMP_USE_TICKS
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+/* -------------------------------------------------------------- */
+/* -------------------- Global functions ------------------------ */
+/* -------------------------------------------------------------- */
+
+
+/**
+ * @brief Cheapest available high resolution timestamp
+ *
+ * @code{cpp}
+ * OSTimestamp::init(); // once, before first measurement
+ * ...
+ * uint32_t start = OSTimestamp::now();
+ * doSomething();
+ * uint64_t ns = OSTimestamp::toNs(OSTimestamp::now() - start);
+ * @endcode
+ *
+ * @note 1. Counter is 32 bit and wraps, so a single interval must be shorter
+ *          than 2^32 / getFrequency() seconds: ~17.9 s for 240MHz CPU,
+ *          ~4.29 s in host builds (nanoseconds are truncated to 32 bit),
+ *          ~49.7 days with 1kHz OS ticks.
+ * @note 2. This class is an ISR safe
+ * @note 3. On multi-core MCU every core has it's own cycle counter,
+ *          so both timestamps must be taken on the same core.
+ */
+class OSTimestamp
+{
+public:
+    /**
+     * @brief Enable counter if hardware requires it (DWT on Cortex-M)
+     */
+    static void init(void)
+    {
+#if defined(OS_TIMESTAMP_USE_DWT)
+        // CoreDebug->DEMCR |= TRCENA; DWT->CTRL |= CYCCNTENA;
+        *reinterpret_cast<volatile uint32_t*>(0xE000EDFCUL) |= (1UL << 24);
+        *reinterpret_cast<volatile uint32_t*>(0xE0001000UL) |= 1UL;
+#endif
+    }
+
+    /**
+     * @brief Get current timestamp in counter units
+     */
+    OS_HOT_SECTION static inline uint32_t now(void)
+    {
+#if defined(OS_TIMESTAMP_USE_CCOUNT)
+        uint32_t ccount;
+        __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+        return ccount;
+#elif defined(OS_TIMESTAMP_USE_ESP_CPU)
+        return (uint32_t)esp_cpu_get_cycle_count();
+#elif defined(OS_TIMESTAMP_USE_DWT)
+        return *reinterpret_cast<volatile uint32_t*>(0xE0001004UL);
+#elif defined(OS_TIMESTAMP_USE_CLOCK_GETTIME)
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+        return (uint32_t)((OS_HELPER_IS_INSIDE_ISR() == pdFALSE) ? xTaskGetTickCount() : xTaskGetTickCountFromISR());
+#endif
+    }
+
+    /**
+     * @brief Get frequency of counter in Hz
+     */
+    static inline uint32_t getFrequency(void)
+    {
+#if defined(OS_TIMESTAMP_USE_CLOCK_GETTIME)
+        return 1000000000UL;
+#elif defined(OS_TIMESTAMP_USE_TICKS)
+        return (uint32_t)configTICK_RATE_HZ;
+#else
+        return (uint32_t)configCPU_CLOCK_HZ;
+#endif
+    }
+
+    /**
+     * @brief Convert difference of two timestamps into nanoseconds
+     *
+     * @note Result is 64 bit, so any delta fits (2^32 ticks of 1kHz is ~4.3e15 ns)
+     */
+    static inline uint64_t toNs(uint32_t delta)
+    {
+        return ((uint64_t)delta * 1000000000ULL) / getFrequency();
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+// clang-format on
+
+#endif // __cplusplus
+
+#endif // _RTOS_HELPER_TIMESTAMP_HPP